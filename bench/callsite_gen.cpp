@@ -0,0 +1,88 @@
+/**
+ * Generates the call site benchmark: a program with 400 distinct logging
+ * call sites, each with 1 to 4 fields drawn from 10 types plus a counter,
+ * split between Logger and ProductionLogger. It measures the cost of a call
+ * when its code is cold, with the cache flushed before each round, and warm.
+ * Comparing the .text size and the timings of two builds shows how much
+ * code each call site instantiates.
+ *
+ * usage: callsite_gen > callsite_bench.cpp
+ */
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+const int sites = 400;
+
+struct Type {
+  const char* name;
+  const char* value;
+};
+
+const Type types[] = {
+    {"int", "1"},       {"long", "7L"},      {"unsigned", "3u"},
+    {"short", "2"},     {"bool", "true"},    {"float", "1.5f"},
+    {"double", "2.5"},  {"const char*", "\"x\""},
+    {"std::string", "\"abc\""},              {"std::string_view", "\"sv\""},
+};
+
+/**
+ * @brief Fixed seed, so every run generates the same program.
+ */
+std::uint32_t state = 46;
+std::uint32_t next(std::uint32_t bound) {
+  state = state * 1664525u + 1013904223u;
+  return (state >> 16) % bound;
+}
+}  // namespace
+
+int main() {
+  printf(
+      "#include <ptclogs/driver/json_driver.hpp>\n"
+      "#include <ptclogs/logs.hpp>\n"
+      "#include <ptclogs/logs_prod.hpp>\n\n"
+      "#include <chrono>\n#include <cstdio>\n#include <string>\n#include <vector>\n\n"
+      "using namespace logger;\n\n"
+      "class NullBuffer : public std::streambuf {\n"
+      " protected:\n"
+      "  int_type overflow(int_type c) override { return c; }\n"
+      "  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }\n"
+      "};\n\n"
+      "NullBuffer null_buffer;\nstd::ostream null_stream(&null_buffer);\n"
+      "Logger<JSONDriver, null_stream> lg(LogLevel::INFO, Field<int>(\"pid\", 1));\n"
+      "ProductionLogger<JSONDriver, LogLevel::INFO, null_stream> pl(Field<int>(\"pid\", 1));\n\n");
+  for (int s = 0; s < sites; s++) {
+    printf("__attribute__((noinline)) void site%d(int i) { %s.INFO(\"site %d\"", s,
+           s % 2 ? "pl" : "lg", s);
+    int fields = 1 + next(4);
+    for (int f = 0; f < fields; f++) {
+      const Type& t = types[next(sizeof types / sizeof *types)];
+      printf(", Field<%s>(\"k%d\", %s)", t.name, f, t.value);
+    }
+    printf(", Field<int>(\"i\", i)); }\n");
+  }
+  printf("\nvoid (*const sites[])(int) = {");
+  for (int s = 0; s < sites; s++) printf("%ssite%d", s ? ", " : "", s);
+  printf(
+      "};\n\n"
+      "std::vector<char> junk(64 << 20);\n\n"
+      "int main() {\n"
+      "  for (auto site : sites) site(0);\n"
+      "  double cold = 0, warm = 0;\n"
+      "  const int rounds = 5;\n"
+      "  for (int r = 0; r < rounds; r++) {\n"
+      "    // evicts the code and data of the sites from every cache level\n"
+      "    for (std::size_t i = 0; i < junk.size(); i += 64) junk[i]++;\n"
+      "    auto t0 = std::chrono::steady_clock::now();\n"
+      "    for (auto site : sites) site(r);\n"
+      "    auto t1 = std::chrono::steady_clock::now();\n"
+      "    for (auto site : sites) site(r);\n"
+      "    auto t2 = std::chrono::steady_clock::now();\n"
+      "    cold += std::chrono::duration<double, std::nano>(t1 - t0).count();\n"
+      "    warm += std::chrono::duration<double, std::nano>(t2 - t1).count();\n"
+      "  }\n"
+      "  printf(\"%%-28s %%8.1f ns/op\\n\", \"cold call site\", cold / rounds / %d);\n"
+      "  printf(\"%%-28s %%8.1f ns/op\\n\", \"warm call site\", warm / rounds / %d);\n"
+      "}\n",
+      sites, sites);
+}
@@ -0,0 +1,101 @@
+#include <ptclogs/driver/console_driver.hpp>
+#include <ptclogs/driver/json_driver.hpp>
+#include <ptclogs/logs.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace logger;
+
+/**
+ * @brief Stream buffer that discards everything, so only formatting is measured.
+ */
+class NullBuffer : public std::streambuf {
+ protected:
+  int_type overflow(int_type c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer null_buffer;
+std::ostream null_stream(&null_buffer);
+
+/**
+ * @brief Runs f repeatedly and prints the best of several rounds, which is the
+ * least disturbed by other load on the machine.
+ */
+template <typename F>
+void run(const char* name, F f) {
+  const int iterations = 500000;
+  double best = 1e300;
+  for (int round = 0; round < 7; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) f(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    if (ns < best) best = ns;
+  }
+  printf("%-28s %8.1f ns/op\n", name, best);
+}
+
+/**
+ * @brief Formats the fixed fragments of a record without taking a timestamp,
+ * which is where per-fragment call overhead shows.
+ */
+template <class Driver>
+void fragments(Driver& driver, int i) {
+  driver.begin_message();
+  driver.print_level(LogLevel::INFO);
+  driver.separator();
+  driver.print_message("request served");
+  driver.separator();
+  driver.print_field("status", 200);
+  driver.field_separator();
+  driver.print_field("latency_us", i);
+  driver.field_separator();
+  driver.print_field("route", "/api/users");
+  driver.end_message();
+}
+
+int main() {
+  JSONDriver json(null_stream);
+  ConsoleDriver console(null_stream);
+  run("json fragments", [&](int i) { fragments(json, i); });
+  run("console fragments", [&](int i) { fragments(console, i); });
+
+  Logger<JSONDriver, null_stream> json_logger(LogLevel::INFO);
+  Logger<ConsoleDriver, null_stream> console_logger(LogLevel::INFO);
+  run("json record", [&](int i) {
+    json_logger.INFO("request served", Field<int>("status", 200),
+                     Field<int>("latency_us", i),
+                     Field<std::string>("route", "/api/users"));
+  });
+  run("console record", [&](int i) {
+    console_logger.INFO("request served", Field<int>("status", 200),
+                        Field<int>("latency_us", i),
+                        Field<std::string>("route", "/api/users"));
+  });
+  auto json_batch = json_logger.Batch();
+  run("json batched record", [&](int i) {
+    json_batch.INFO("request served", Field<int>("status", 200),
+                    Field<int>("latency_us", i),
+                    Field<std::string>("route", "/api/users"));
+    if (json_batch.size() == 64) json_batch.Commit();
+  });
+  using RequestServed = Event<"request served", Slot<"status", int>, Slot<"latency_us", int>,
+                               Slot<"route", std::string_view>>;
+  run("json event", [&](int i) { json_logger.INFO(RequestServed(200, i, "/api/users")); });
+  run("console event", [&](int i) { console_logger.INFO(RequestServed(200, i, "/api/users")); });
+  run("json concatenated message", [&](int i) {
+    json_logger.INFO("served /api/users with 200 in " + std::to_string(i) + "us");
+  });
+  run("json formatted message", [&](int i) {
+    json_logger.INFO("served {} with {} in {}us", "/api/users", 200, i);
+  });
+  run("disabled formatted debug", [&](int i) {
+    json_logger.DEBUG("served {} with {} in {}us", "/api/users", 200, i);
+  });
+  run("disabled debug", [&](int i) {
+    json_logger.DEBUG("request served", Field<int>("latency_us", i));
+  });
+}
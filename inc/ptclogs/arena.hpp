@@ -0,0 +1,73 @@
+#ifndef PTCLOGS_ARENA_HPP
+#define PTCLOGS_ARENA_HPP
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace logger {
+/**
+ * @brief Bump allocator over fixed size blocks taken from a per thread pool.
+ *
+ * Blocks go back to the pool of the releasing thread, so once a thread's pool
+ * is warm, filling and releasing arenas doesn't touch the heap. New blocks
+ * come from memory::resource and are counted in memory::usage. Memory is only
+ * reclaimed as a whole by release; objects are not destroyed by the arena.
+ */
+class Arena {
+ public:
+  /**
+   * @brief Bytes of a pooled block, including its header. Larger allocations
+   * get a block of their own, which is freed instead of pooled.
+   */
+  static constexpr std::size_t block_size = 1 << 14;
+
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena() { release(); }
+
+  /**
+   * @brief Returns size bytes aligned to align.
+   */
+  void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+  /**
+   * @brief Constructs a T in the arena.
+   */
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Returns every block to the pool.
+   */
+  void release();
+
+  /**
+   * @brief Returns the bytes of the blocks held now, and the most held at
+   * once since the arena was created.
+   */
+  std::size_t size() const { return held; }
+  std::size_t high_water() const { return peak; }
+
+  /**
+   * @brief Header of a block, followed by its memory.
+   */
+  struct Block {
+    Block* next;
+    std::size_t size;
+    std::pmr::memory_resource* resource;
+  };
+
+ private:
+  Block* blocks = nullptr;
+  std::size_t held = 0;
+  std::size_t peak = 0;
+  char* cursor = nullptr;
+  char* end = nullptr;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_ARENA_HPP
@@ -0,0 +1,184 @@
+#ifndef PTCLOGS_BATCH_HPP
+#define PTCLOGS_BATCH_HPP
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ptclogs/clock.hpp"
+#include "ptclogs/context.hpp"
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/erased.hpp"
+#include "ptclogs/probes.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+#include "ptclogs/telemetry.hpp"
+
+namespace logger {
+struct BatchOptions {
+  /**
+   * @brief Take a timestamp for every record. By default every record of a
+   * batch carries the time the batch was opened or last committed.
+   */
+  bool record_timestamps = false;
+};
+
+/**
+ * @brief Records appended in bulk and written together.
+ *
+ * The timestamp is taken once, the timestamp and level section of each level
+ * and the context fields are rendered once, and Commit writes every record to
+ * the stream at once and flushes it once. Record oriented buffers still get
+ * the records one by one, through commit_batch. Lazy and StreamArray values of
+ * the context are rendered once per batch.
+ *
+ * FATAL records aren't batched, log them on the logger.
+ *
+ * Usage:
+ *   auto batch = logger.Batch();
+ *   for (auto& item : items)
+ *     batch.INFO("item done", Field("id", item.id), Field("bytes", item.size));
+ *   // written when the batch goes out of scope, or on batch.Commit()
+ *
+ * @tparam Driver Driver that formats the records.
+ * @tparam out Stream the records are written to.
+ */
+template <LogDriver Driver, std::ostream& out>
+class LogBatch {
+ public:
+  /**
+   * @brief Opens a batch. Use Logger::Batch instead.
+   */
+  LogBatch(LogLevel log_level, const Context<Driver>& context, BatchOptions options)
+      : log_level(log_level), context(context), options(options), driver(text) {}
+
+  LogBatch(const LogBatch&) = delete;
+  LogBatch& operator=(const LogBatch&) = delete;
+
+  /**
+   * @brief Commits the records still pending.
+   */
+  ~LogBatch() { Commit(); }
+
+  template <typename... Args>
+  void ERROR(std::string_view message, Field<Args>... args) {
+    append(LogLevel::ERROR, message, args...);
+  }
+
+  template <typename... Args>
+  void WARN(std::string_view message, Field<Args>... args) {
+    append(LogLevel::WARN, message, args...);
+  }
+
+  template <typename... Args>
+  void INFO(std::string_view message, Field<Args>... args) {
+    append(LogLevel::INFO, message, args...);
+  }
+
+  template <typename... Args>
+  void DEBUG(std::string_view message, Field<Args>... args) {
+    append(LogLevel::DEBUG, message, args...);
+  }
+
+  /**
+   * @brief Writes the pending records with a single write and flush. The
+   * batch can then be reused, with a new timestamp.
+   */
+  void Commit() {
+    if (records.empty()) return;
+    std::string_view data = text.view();
+    LogLevel most_severe = LogLevel::DEBUG;
+    for (auto& record : records)
+      if (record.level < most_severe) most_severe = record.level;
+    set_record_level(most_severe);
+    set_record_batch(records.data(), records.size());
+    out.write(data.data(), data.size());
+    out.flush();
+    set_record_batch(nullptr, 0);
+    records.clear();
+    text.str("");
+    stamp = 0;
+    for (auto& prefix : prefixes) prefix.clear();
+  }
+
+  /**
+   * @brief Returns the number of pending records.
+   */
+  std::size_t size() const { return records.size(); }
+
+ private:
+  template <typename... Args>
+  void append(LogLevel level, std::string_view message, const Field<Args>&... args) {
+    if (log_level < level) return;
+    ptclogs_probe_write(level, message);
+    auto telemetry_stamp = telemetry::start();
+    if (options.record_timestamps) {
+      driver.begin_message();
+      driver.print_timestamp();
+      driver.separator();
+      driver.print_level(level);
+      driver.separator();
+    } else {
+      const std::string& prefix = record_prefix(level);
+      text.write(prefix.data(), prefix.size());
+    }
+    driver.print_message(message);
+
+    if (!rendered_context) render_context();
+    text.write(context_bytes.data(), context_bytes.size());
+    int count = context.size();
+    const ErasedField<Driver> fields[sizeof...(Args) + 1] = {args...};
+    write_fields(driver, count, fields, sizeof...(Args));
+    driver.end_message();
+    text.put('\n');
+    records.push_back(BatchRecord{level, std::size_t(text.tellp())});
+    telemetry::record(level, telemetry_stamp);
+  }
+
+  /**
+   * @brief Returns the section before the message of a record at level,
+   * rendering it on first use with the timestamp of the batch.
+   */
+  const std::string& record_prefix(LogLevel level) {
+    std::string& prefix = prefixes[level];
+    if (!prefix.empty()) return prefix;
+    if (!stamp) stamp = clock::stamp();
+    std::ostringstream section;
+    Driver d(section);
+    std::uint64_t replaying = clock::replay_stamp;
+    clock::replay_stamp = stamp;
+    d.begin_message();
+    d.print_timestamp();
+    d.separator();
+    d.print_level(level);
+    d.separator();
+    clock::replay_stamp = replaying;
+    prefix = section.str();
+    return prefix;
+  }
+
+  void render_context() {
+    std::ostringstream section;
+    Driver d(section);
+    int count = 0;
+    context.print(d, section, count);
+    context_bytes = section.str();
+    rendered_context = true;
+  }
+
+  LogLevel log_level;
+  Context<Driver> context;
+  BatchOptions options;
+  std::ostringstream text;
+  Driver driver;
+  std::vector<BatchRecord> records;
+  std::uint64_t stamp = 0;
+  std::string prefixes[5];
+  std::string context_bytes;
+  bool rendered_context = false;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_BATCH_HPP
@@ -0,0 +1,135 @@
+#ifndef PTCLOGS_CALLSITE_HPP
+#define PTCLOGS_CALLSITE_HPP
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/probes.hpp"
+
+namespace logger {
+/**
+ * @brief A log statement, declared by ptclogs_debug as a constant initialized
+ * static, so it costs nothing until it first runs.
+ *
+ * Each site has a one byte state checked on the hot path: by default it
+ * follows the level of the logger, and it can be switched on or off at
+ * runtime, by itself or through a pattern, without touching other sites. A
+ * site registers itself the first time it runs, taking the state the rules
+ * set so far give it.
+ */
+struct CallSite {
+  enum State : std::uint8_t { NEW, DEFAULT, ON, OFF };
+
+  constexpr CallSite(const char* file, int line, const char* function, LogLevel level)
+      : file(file), function(function), line(line), level(level) {}
+
+  /**
+   * @brief Returns whether a record of this site is written by a logger at
+   * logger_level.
+   */
+  bool enabled(LogLevel logger_level) {
+    State s = state.load(std::memory_order_relaxed);
+    if (s == NEW) [[unlikely]]
+      s = enroll();
+    return s == DEFAULT ? level <= logger_level : s == ON;
+  }
+
+  const char* file;
+  const char* function;
+  int line;
+  LogLevel level;
+  std::atomic<State> state{NEW};
+  CallSite* next = nullptr;
+
+ private:
+  State enroll();
+};
+
+/**
+ * Runtime control of call sites.
+ *
+ * A rule is a state and a glob pattern, written "+pattern" to switch sites
+ * on, "-pattern" to switch them off and "=pattern" to make them follow the
+ * logger level again. The pattern is matched against "file:line", with the
+ * file as in __FILE__ and as its last component, and against the function
+ * name, e.g. "+cache.cpp:*", "-src/cache.cpp:120" or "+handle_*". Rules apply in
+ * order, so later rules win, and are remembered to cover sites that haven't
+ * run yet. A rule replaces an earlier one with the same pattern.
+ */
+namespace callsites {
+/**
+ * @brief Sets the state of the sites matching pattern.
+ *
+ * @return Number of sites changed.
+ */
+std::size_t set(std::string_view pattern, CallSite::State state);
+
+/**
+ * @brief Applies one rule.
+ *
+ * @return Number of sites changed, or -1 if the rule is malformed.
+ */
+long apply(std::string_view rule);
+
+/**
+ * @brief Puts every site back to DEFAULT and forgets the rules.
+ */
+void reset();
+
+/**
+ * @brief Replaces every rule with the given ones at once, so no site is seen
+ * in between states. Malformed rules are skipped.
+ */
+void replace(const std::vector<std::string>& rules);
+
+/**
+ * @brief Calls f with every site that ran at least once.
+ */
+void for_each(const std::function<void(const CallSite&)>& f);
+
+/**
+ * @brief Watches a control file from a background thread. Whenever it
+ * changes, the rules in it, one per line, replace the current ones. Empty
+ * lines and lines starting with '#' are skipped.
+ *
+ * There is one watching thread: calling watch again makes it watch path at
+ * interval instead. It is stopped at exit or by unwatch.
+ *
+ * @param path Control file, which doesn't need to exist yet.
+ * @param interval How often the file is checked.
+ */
+void watch(const std::string& path,
+           std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+/**
+ * @brief Stops and joins the watching thread, if any. The rules it loaded
+ * stay in place.
+ */
+void unwatch();
+};  // namespace callsites
+};  // namespace logger
+
+/**
+ * @brief Logs at DEBUG level from a registered call site, written when the
+ * site is switched on or, by default, when the logger is at DEBUG level.
+ * The message and fields aren't evaluated when the site is disabled.
+ *
+ * Usage:
+ *   ptclogs_debug(log, "cache miss", Field("key", key));
+ */
+#define ptclogs_debug(log, ...)                                                  \
+  do {                                                                           \
+    static constinit logger::CallSite ptclogs_site(__FILE__, __LINE__, __func__, \
+                                                   logger::LogLevel::DEBUG);     \
+    ptclogs_probe_log_at(logger::LogLevel::DEBUG, &ptclogs_site, __FILE__,       \
+                         __LINE__, "");                                          \
+    if (ptclogs_site.enabled((log).GetLogLevel()))                               \
+      (log).DEBUG(ptclogs_site, __VA_ARGS__);                                    \
+  } while (0)
+
+#endif  // PTCLOGS_CALLSITE_HPP
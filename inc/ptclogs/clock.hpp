@@ -0,0 +1,52 @@
+#ifndef PTCLOGS_CLOCK_HPP
+#define PTCLOGS_CLOCK_HPP
+#include <cstdint>
+
+/**
+ * Time source of record timestamps.
+ *
+ * By default a stamp is the CLOCK_REALTIME time in nanoseconds. When the
+ * library is built with PTCLOGS_TSC (make TSC=1) and the cpu has an invariant
+ * TSC, a stamp is a raw rdtsc reading instead, and a background thread
+ * periodically calibrates the TSC rate against CLOCK_MONOTONIC_RAW and
+ * rereads the offset of CLOCK_REALTIME to convert stamps to wall time. Without an invariant TSC it falls back to the OS clock.
+ */
+namespace logger::clock {
+
+/**
+ * @brief Returns whether stamps are TSC readings.
+ */
+bool tsc();
+
+/**
+ * @brief Captures the current time as a stamp. With the TSC this is a single
+ * rdtsc instruction.
+ */
+std::uint64_t stamp();
+
+/**
+ * @brief Converts a stamp to nanoseconds since the unix epoch.
+ *
+ * @param stamp Stamp returned by stamp().
+ */
+std::int64_t to_unix_ns(std::uint64_t stamp);
+
+/**
+ * @brief Returns the current time in nanoseconds since the unix epoch.
+ */
+inline std::int64_t now() { return to_unix_ns(stamp()); }
+
+/**
+ * @brief Stamp of the record this thread writes when it was logged earlier
+ * than it is written, 0 otherwise.
+ */
+inline thread_local std::uint64_t replay_stamp = 0;
+
+/**
+ * @brief Returns the time of the record this thread writes, in nanoseconds
+ * since the unix epoch.
+ */
+inline std::int64_t record_time() { return replay_stamp ? to_unix_ns(replay_stamp) : now(); }
+};  // namespace logger::clock
+
+#endif  // PTCLOGS_CLOCK_HPP
@@ -0,0 +1,227 @@
+#ifndef PTCLOGS_COLUMNAR_HPP
+#define PTCLOGS_COLUMNAR_HPP
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ptclogs/driver/idriver.hpp"
+
+/**
+ * Columnar segment files written by ColumnarFileBuffer.
+ *
+ * A segment starts with the 8 byte magic and is followed by blocks. A block
+ * holds records of the same shape, the same keys in the same order, stored
+ * column by column, and describes itself, so blocks can be read one at a
+ * time and columns skipped without being decoded. Integers are varints,
+ * signed ones zigzag encoded:
+ *
+ *   varint size       bytes of the block after this field
+ *   varint records
+ *   u8 flags          VERBATIM: the only column holds lines that weren't JSON
+ *   varint keys       then each key as varint length and bytes
+ *   column ts         commit time, nanoseconds since the epoch, delta of
+ *                     delta encoded
+ *   column level      levels bit packed
+ *   column per key    in key order
+ *
+ * Each column is its varint size followed by its bytes, and the columns of
+ * keys start with their encoding:
+ *
+ *   INT   all values are integers: minimum, bit width, values - minimum
+ *         bit packed
+ *   DICT  few distinct values: dictionary of values, bit width, indices bit
+ *         packed
+ *   RAW   each value as varint length and bytes
+ *
+ * Values are kept as they are written in JSON: when the encoding has the
+ * QUOTED bit, every value is the escaped text of a string, otherwise every
+ * value is a JSON literal. The ts field of a record is a key like any other,
+ * only level is left to the level column, so records come back as written.
+ */
+namespace logger::columnar {
+
+constexpr char magic[8] = {'P', 'T', 'C', 'C', 'O', 'L', '1', '\n'};
+
+enum Encoding : std::uint8_t { INT = 1, DICT = 2, RAW = 3 };
+
+constexpr std::uint8_t QUOTED = 0x80;
+constexpr std::uint8_t VERBATIM = 1;
+
+struct SegmentOptions {
+  /**
+   * @brief Records of a shape per block.
+   */
+  std::size_t block_records = 4096;
+  /**
+   * @brief Shapes buffered at once. Past it, every buffered block is written.
+   */
+  std::size_t max_shapes = 64;
+  /**
+   * @brief Most distinct values of a dictionary column, past it a column
+   * falls back to RAW.
+   */
+  std::size_t max_dictionary = 4096;
+  /**
+   * @brief How long records wait for their block to fill. Past it, give or
+   * take half of it, the block is written as it is. Zero writes blocks only
+   * once they are full.
+   */
+  std::chrono::milliseconds flush_interval{1000};
+};
+
+void put_varint(std::string& out, std::uint64_t value);
+
+/**
+ * @brief Reads a varint at the start of in and advances in past it.
+ *
+ * @return Whether there was a complete varint.
+ */
+bool get_varint(std::string_view& in, std::uint64_t& value);
+
+inline std::uint64_t zigzag(std::int64_t v) { return (std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63); }
+inline std::int64_t unzigzag(std::uint64_t v) { return std::int64_t(v >> 1) ^ -std::int64_t(v & 1); }
+
+/**
+ * @brief Returns the number of bits needed for value.
+ */
+inline unsigned bit_width(std::uint64_t value) {
+  return value ? 64 - __builtin_clzll(value) : 0;
+}
+
+/**
+ * @brief Appends values of width bits each, least significant bit first.
+ */
+void pack(std::string& out, const std::vector<std::uint64_t>& values, unsigned width);
+
+/**
+ * @brief Returns the value at index of data packed by pack.
+ */
+std::uint64_t unpack(std::string_view data, std::size_t index, unsigned width);
+
+/**
+ * @brief Accumulates records of one shape and encodes them as a block.
+ */
+class BlockBuilder {
+ public:
+  /**
+   * @param keys Keys of the shape, in order.
+   * @param flags Block flags.
+   * @param options Dictionary limit.
+   */
+  BlockBuilder(std::vector<std::string> keys, std::uint8_t flags, const SegmentOptions& options);
+
+  /**
+   * @brief Starts a record. Its values are then added in key order.
+   */
+  void add_record(std::int64_t ns, LogLevel level);
+
+  /**
+   * @brief Adds the value of the next key of the current record.
+   *
+   * @param value Value as written in JSON, without the quotes of a string.
+   * @param quoted Whether the value is a string.
+   */
+  void add_value(std::size_t column, std::string_view value, bool quoted);
+
+  std::size_t records() const { return timestamps.size(); }
+
+  /**
+   * @brief Returns the time of the first record, when there is one.
+   */
+  std::int64_t first_time() const { return timestamps.front(); }
+
+  /**
+   * @brief Appends the encoded block to out and empties the builder.
+   */
+  void encode(std::string& out);
+
+ private:
+  struct Pending {
+    std::string bytes;
+    std::vector<std::uint32_t> ends;
+    std::vector<bool> quoted;
+    bool any_quoted = false;
+    bool any_literal = false;
+    bool integers = true;
+  };
+
+  void encode_column(std::string& out, Pending& column);
+
+  std::vector<std::string> keys;
+  std::uint8_t flags;
+  std::size_t max_dictionary;
+  std::vector<std::int64_t> timestamps;
+  std::vector<std::uint64_t> levels;
+  std::vector<Pending> columns;
+};
+
+/**
+ * @brief A column of a block, decoded on demand.
+ */
+struct Column {
+  std::string_view key;
+  /**
+   * @brief Encoded bytes, starting with the encoding for key columns.
+   */
+  std::string_view data;
+
+  /**
+   * @brief Decodes the values as they are written in JSON. Strings are
+   * given without quotes when quoted is set.
+   *
+   * @param count Records of the block.
+   * @param out Values, views into the block or into storage.
+   * @param storage Text of values that aren't stored as text.
+   * @param quoted Whether every value is a string.
+   * @return Whether the column is well formed.
+   */
+  bool values(std::size_t count, std::vector<std::string_view>& out,
+              std::vector<std::string>& storage, bool& quoted) const;
+};
+
+/**
+ * @brief A block of a segment, parsed up to its columns.
+ */
+struct Block {
+  std::size_t records = 0;
+  std::uint8_t flags = 0;
+  Column ts;
+  Column level;
+  std::vector<Column> columns;
+
+  /**
+   * @brief Parses the block at the start of in and advances in past it.
+   */
+  bool parse(std::string_view& in);
+
+  /**
+   * @brief Returns the column of key, or nullptr.
+   */
+  const Column* find(std::string_view key) const;
+
+  bool timestamps(std::vector<std::int64_t>& out) const;
+  bool levels(std::vector<LogLevel>& out) const;
+};
+
+/**
+ * @brief Calls f with every block of a segment.
+ *
+ * @return Whether the whole segment was well formed.
+ */
+template <typename F>
+bool for_each_block(std::string_view segment, F&& f) {
+  if (segment.substr(0, sizeof magic) != std::string_view(magic, sizeof magic)) return false;
+  segment.remove_prefix(sizeof magic);
+  Block block;
+  while (!segment.empty()) {
+    if (!block.parse(segment)) return false;
+    f(block);
+  }
+  return true;
+}
+};  // namespace logger::columnar
+
+#endif  // PTCLOGS_COLUMNAR_HPP
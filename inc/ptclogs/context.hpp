@@ -0,0 +1,207 @@
+#ifndef PTCLOGS_CONTEXT_HPP
+#define PTCLOGS_CONTEXT_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/memory.hpp"
+#include "ptclogs/value.hpp"
+
+namespace logger {
+/**
+ * @brief Writes a field of a record, preceded by the separator it needs. The
+ * counter holds how many fields of the record were written so far.
+ */
+template <class Driver, typename T>
+void write_field(Driver& driver, int& count, const Field<T>& field) {
+  if (count++)
+    driver.field_separator();
+  else
+    driver.separator();
+  driver.print_field(field.header, field.value);
+}
+
+/**
+ * @brief Values rendered each time their record is written, which a context
+ * keeps as they are instead of rendering them once.
+ */
+template <typename T>
+struct is_deferred
+    : std::integral_constant<bool, is_lazy<T>::value || is_stream_array<T>::value> {};
+
+/**
+ * @brief Context fields of a logger, shared by its children and copied
+ * without allocating.
+ *
+ * The fields are rendered by Driver once, when the context is created, and
+ * records only copy the rendered bytes. Those of the latest fields are kept
+ * inline while they fit, past it and for parents they are held by immutable
+ * reference counted nodes, so a child logger adds a reference to what its
+ * parent rendered instead of copying it. Nodes are allocated from
+ * memory::resource. Lazy and StreamArray values are kept unrendered and
+ * written with every record.
+ *
+ * @tparam Driver Driver that renders the fields.
+ */
+template <class Driver>
+class Context {
+ public:
+  /**
+   * @brief Rendered bytes kept inline, sized so a context takes 64 bytes.
+   */
+  static constexpr std::size_t inline_capacity = 53;
+
+  Context() = default;
+
+  Context(const Context& other)
+      : node(other.node), length(other.length), fields(other.fields) {
+    std::memcpy(bytes, other.bytes, length);
+    if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Context& operator=(const Context& other) {
+    Context copy(other);
+    std::swap(node, copy.node);
+    std::memcpy(bytes, copy.bytes, copy.length);
+    length = copy.length;
+    fields = copy.fields;
+    return *this;
+  }
+
+  ~Context() { release(node); }
+
+  /**
+   * @brief Returns a context with the given fields after the fields of this
+   * one.
+   */
+  template <typename... Args>
+  Context with(const Field<Args>&... extra) const;
+
+  /**
+   * @brief Writes the fields and sets count to how many there are.
+   */
+  void print(Driver& driver, std::ostream& out, int& count) const {
+    if (node) node->print(driver, out, count);
+    out.write(bytes, length);
+    count = fields;
+  }
+
+  /**
+   * @brief Returns the number of fields.
+   */
+  std::size_t size() const { return fields; }
+
+ private:
+  struct Node;
+  struct Rendered;
+  template <typename... Args>
+  struct Deferred;
+
+  template <typename N, typename... Args>
+  static const Node* create(Args&&... args) {
+    std::pmr::memory_resource* resource = memory::resource();
+    N* node = new (resource->allocate(sizeof(N), alignof(std::max_align_t)))
+        N(resource, std::forward<Args>(args)...);
+    node->size = sizeof(N);
+    return node;
+  }
+
+  static void release(const Node* node) {
+    if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::pmr::memory_resource* resource = node->resource;
+      std::size_t size = node->size;
+      node->~Node();
+      resource->deallocate(const_cast<Node*>(node), size, alignof(std::max_align_t));
+    }
+  }
+
+  const Node* node = nullptr;
+  char bytes[inline_capacity];
+  std::uint8_t length = 0;
+  std::uint16_t fields = 0;
+};
+
+template <class Driver>
+struct Context<Driver>::Node {
+  Node(std::pmr::memory_resource* resource, const Context& parent)
+      : resource(resource), parent(parent) {}
+  virtual ~Node() = default;
+  virtual void print(Driver& driver, std::ostream& out, int& count) const = 0;
+
+  mutable std::atomic<std::size_t> refs{1};
+  std::pmr::memory_resource* resource;
+  std::size_t size = 0;
+  Context parent;
+};
+
+template <class Driver>
+struct Context<Driver>::Rendered : Node {
+  Rendered(std::pmr::memory_resource* resource, const Context& parent, std::string_view bytes)
+      : Node(resource, parent), bytes(bytes, resource) {}
+  void print(Driver& driver, std::ostream& out, int& count) const override {
+    this->parent.print(driver, out, count);
+    out.write(bytes.data(), bytes.size());
+  }
+
+  std::pmr::string bytes;
+};
+
+template <class Driver>
+template <typename... Args>
+struct Context<Driver>::Deferred : Node {
+  Deferred(std::pmr::memory_resource* resource, const Context& parent,
+           const Field<Args>&... fields)
+      : Node(resource, parent), fields(fields...) {}
+  void print(Driver& driver, std::ostream& out, int& count) const override {
+    this->parent.print(driver, out, count);
+    std::apply([&](const auto&... fields) { (write_field(driver, count, fields), ...); },
+               fields);
+  }
+
+  std::tuple<Field<Args>...> fields;
+};
+
+template <class Driver>
+template <typename... Args>
+Context<Driver> Context<Driver>::with(const Field<Args>&... extra) const {
+  if constexpr (sizeof...(Args) == 0) {
+    return *this;
+  } else {
+    Context child;
+    child.fields = fields + sizeof...(Args);
+    if constexpr ((is_deferred<Args>::value || ...)) {
+      child.node = create<Deferred<Args...>>(*this, extra...);
+    } else {
+      memory::Scratch<std::ostringstream> text;
+      text->str("");
+      Driver driver(*text);
+      int count = fields;
+      (write_field(driver, count, extra), ...);
+      std::string_view rendered = text->view();
+      if (length + rendered.size() <= inline_capacity) {
+        child.node = node;
+        if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+        std::memcpy(child.bytes, bytes, length);
+        std::memcpy(child.bytes + length, rendered.data(), rendered.size());
+        child.length = length + rendered.size();
+      } else {
+        child.node = create<Rendered>(*this, rendered);
+      }
+    }
+    return child;
+  }
+}
+};  // namespace logger
+
+#endif  // PTCLOGS_CONTEXT_HPP
@@ -1,33 +1,63 @@
 #ifndef LOGS_CONSOLE_DRIVER_H
 #define LOGS_CONSOLE_DRIVER_H
+#include <string_view>
+
 #include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/value.hpp"
 namespace logger{
 /**
  * @brief Prints logs to the console formatted in a human readable way. Log levels are colored.
  */
-class ConsoleDriver : IDriver {
+class ConsoleDriver : public IDriver {
  public:
   ConsoleDriver(std::ostream& out) : IDriver(out){};
-  void begin_message();
-  void end_message();
+  void begin_message() {}
+  void end_message() {}
   template <typename T>
-  void print_field(std::string header, T value);
-  void print_message(std::string message);
+  void print_field(std::string_view header, const T& value);
+  void print_message(std::string_view message) { out << message; }
   void print_timestamp();
   void print_level(LogLevel level);
-  void separator();
-  void field_separator();
+  void separator() { out << '\t'; }
+  void field_separator() { out << ", "; }
+  template <typename T>
+  void print_object(const T& object);
+
+  /**
+   * @brief Structural primitives used by write_value to render nested values.
+   */
+  void begin_array() { out << '['; }
+  void end_array() { out << ']'; }
+  void begin_object() { out << '{'; }
+  void end_object() { out << '}'; }
+  void value_separator() { out << ", "; }
+  void write_null() { out << "null"; }
+  void write_bool(bool value) { out << (value ? "true" : "false"); }
+  void write_string(std::string_view value) { out << value; }
+  template <typename K>
+  void write_key(const K& key) { out << key << ": "; }
   template <typename T>
-  void print_object(T object);
+  void write_number(T value);
+  template <typename T>
+  void write_raw(const T& value) { out << value; }
 };
 };  // namespace logger
 
-template <typename T> void logger::ConsoleDriver::print_field(std::string header, T value) {
-  out << header << ": " << value;
+template <typename T>
+void logger::ConsoleDriver::print_field(std::string_view header, const T& value) {
+  write_key(header);
+  write_value(*this, value);
 }
 template<typename T>
-void logger::ConsoleDriver::print_object(T value) {
-  out << value;
+void logger::ConsoleDriver::print_object(const T& value) {
+  write_value(*this, value);
+}
+template <typename T>
+void logger::ConsoleDriver::write_number(T value) {
+  if constexpr (sizeof(T) == 1)
+    out << int(value);
+  else
+    out << value;
 }
 
 #endif // LOGS_CONSOLE_DRIVER_H
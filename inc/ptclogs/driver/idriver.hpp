@@ -1,11 +1,51 @@
 #ifndef LOGS_DRIVER_H
 #define LOGS_DRIVER_H
+#include <concepts>
 #include <ostream>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace logger {
 enum LogLevel { FATAL, ERROR, WARN, INFO, DEBUG };
 
+/**
+ * @brief Returns the upper case name of a log level.
+ *
+ * @param level Level whose name is returned.
+ */
+constexpr std::string_view level_name(LogLevel level) {
+  switch (level) {
+    case FATAL:
+      return "FATAL";
+    case ERROR:
+      return "ERROR";
+    case WARN:
+      return "WARN";
+    case INFO:
+      return "INFO";
+    case DEBUG:
+      return "DEBUG";
+  }
+  return "";
+}
+
+/**
+ * @brief Parses the upper case name of a log level.
+ *
+ * @param name Name as returned by level_name.
+ * @param level Set to the parsed level.
+ * @return Whether name is the name of a level.
+ */
+constexpr bool parse_level(std::string_view name, LogLevel& level) {
+  for (int l = FATAL; l <= DEBUG; l++)
+    if (level_name(LogLevel(l)) == name) {
+      level = LogLevel(l);
+      return true;
+    }
+  return false;
+}
+
 /**
  * @brief Field containing a value to be logged.
  *
@@ -21,11 +61,18 @@ class Field {
    * @param header Header that will be printed alongside the field.
    * @param value Value of the field.
    */
-  Field(std::string header, T value) : header(header), value(value){};
+  Field(std::string header, T value) : value(value), header(header){};
   T value;
   std::string header;
 };
 
+/**
+ * @brief State shared by every driver: the stream it writes to and the keys of
+ * the fixed record sections.
+ *
+ * Drivers are resolved at compile time by the loggers, so nothing here is
+ * virtual. The operations a driver has to provide are listed by LogDriver.
+ */
 class IDriver {
  public:
   /**
@@ -36,74 +83,49 @@ class IDriver {
   IDriver(std::ostream& out) : out(out){};
 
   /**
-   * @brief Writes the beggining of the message to out.
+   * @brief Renames the keys of the fixed record sections for every driver.
+   * They are shared rather than held by each driver, so set them once, before
+   * logging.
    *
+   * @param message Key of the message, "msg" by default.
+   * @param timestamp Key of the timestamp, "ts" by default.
+   * @param level Key of the level, "level" by default.
    */
-  virtual void begin_message() = 0;
-
-  /**
-   * @brief Writes the end of the message to out.
-   *
-   */
-  virtual void end_message() = 0;
-
-  /**
-   * @brief Prints a field.
-   *
-   * @tparam T Type of the field.
-   * @param header Header of the field.
-   * @param value Value of the field.
-   */
-  template <typename T>
-  void print_field(std::string header, T value);
-
-  /**
-   * @brief Prints a message to out
-   *
-   * @param message Message that will be printed.
-   */
-  virtual void print_message(std::string message) = 0;
-
-  /**
-   * @brief Printes the current timestamp to out.
-   *
-   */
-  virtual void print_timestamp() = 0;
-
-  /**
-   * @brief Prints a log level to out.
-   *
-   * @param level [TODO:description]
-   */
-  virtual void print_level(LogLevel level) = 0;
-
-  /**
-   * @brief Prints the separator between message sections.
-   *
-   */
-  virtual void separator() = 0;
-
-  /**
-   * @brief Prints the separator between fields.
-   *
-   */
-  virtual void field_separator() = 0;
-
-  /**
-   * @brief Prints an object to out.
-   *
-   * @tparam T Type of the object.
-   * @param object Object to be printed.
-   */
-  template <typename T>
-  void print_object(T object);
+  static void set_keys(std::string message, std::string timestamp, std::string level) {
+    messageKey = std::move(message);
+    timestampKey = std::move(timestamp);
+    levelKey = std::move(level);
+  }
 
  protected:
   std::string timestamp();
   std::ostream& out;
-  std::string messageKey = "msg";
-  std::string timestampKey = "ts";
-  std::string levelKey = "level";
+  static inline std::string messageKey = "msg";
+  static inline std::string timestampKey = "ts";
+  static inline std::string levelKey = "level";
+};
+
+/**
+ * @brief Operations a logger calls on its driver to write one record.
+ *
+ * - begin_message / end_message: open and close a record.
+ * - print_timestamp, print_level, print_message: the fixed sections.
+ * - print_field(header, value): a field, print_object(object): a bare object.
+ * - separator / field_separator: between sections and between fields.
+ */
+template <class D>
+concept LogDriver = std::constructible_from<D, std::ostream&> &&
+    requires(D driver, std::string_view text, LogLevel level) {
+  driver.begin_message();
+  driver.end_message();
+  driver.print_timestamp();
+  driver.print_level(level);
+  driver.print_message(text);
+  driver.print_field(text, 0);
+  driver.print_field(text, text);
+  driver.print_object(text);
+  driver.separator();
+  driver.field_separator();
 };
 
 };  // namespace logger
@@ -1,46 +1,76 @@
 #ifndef LOGS_JSON_DRIVER_H
 #define LOGS_JSON_DRIVER_H
 
-#include "ptclogs/driver/idriver.hpp"
+#include <cmath>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+
+#include "ptclogs/driver/key_value_driver.hpp"
 
 namespace logger{
 /**
- * @brief Driver that prints logs formatted as json objects. Strings get quoted, other objects get printed as they are.
+ * @brief Driver that prints logs formatted as json objects. Strings get quoted
+ * and escaped, containers and nested objects become json arrays and objects,
+ * other objects become the string their operator<< prints.
  */
-class JSONDriver : IDriver {
+class JSONDriver : public KeyValueDriver<JSONDriver> {
  public:
-  JSONDriver(std::ostream& out) : IDriver(out) {};
-  void begin_message();
-  void end_message();
+  JSONDriver(std::ostream& out) : KeyValueDriver(out) {};
+  void begin_message() { out << '{'; }
+  void end_message() { out << '}'; }
+  void separator() { out << ','; }
+  void field_separator() { out << ','; }
+
+  void begin_array() { out << '['; }
+  void end_array() { out << ']'; }
+  void begin_object() { out << '{'; }
+  void end_object() { out << '}'; }
+  void value_separator() { out << ','; }
+  void write_null() { out << "null"; }
+  void write_bool(bool value) { out << (value ? "true" : "false"); }
+  void write_string(std::string_view value);
+  template <typename K>
+  void write_key(const K& key);
   template <typename T>
-  void print_field(std::string header, T value);
-  void print_field(std::string header, std::string value);
-  void print_field(std::string header, char* value);
-  void print_field(std::string header, const char* value);
-
-  void print_message(std::string message);
-  void print_timestamp();
-  void print_level(LogLevel level);
-  void separator();
-  void field_separator();
+  void write_number(T value);
   template <typename T>
-  void print_object(T object);
-  void print_object(std::string object); 
-  void print_object(char const* object); 
-  void print_object(char* object); 
-
- private:
-  std::string quote(std::string str);
+  void write_raw(const T& value);
 };
 };  // namespace logger
 
+template <typename K>
+void logger::JSONDriver::write_key(const K& key) {
+    if constexpr (is_string_like<K>::value) {
+	write_string(std::string_view(key));
+    } else {
+	// json keys are always strings
+	write_raw(key);
+    }
+    out << ':';
+}
+
+/**
+ * @brief Writes what operator<< prints for value as a json string, so its
+ * text is escaped like any other. A local stream, since operator<< may log
+ * records of its own.
+ */
 template <typename T>
-void logger::JSONDriver::print_field(std::string header, T value) {
-    out << quote(header) << ":" << value;
+void logger::JSONDriver::write_raw(const T& value) {
+    std::ostringstream text;
+    text << value;
+    write_string(text.view());
 }
+
 template <typename T>
-void logger::JSONDriver::print_object(T object) {
-    out << quote(messageKey) << ":" << object;
+void logger::JSONDriver::write_number(T value) {
+    if constexpr (std::is_floating_point<T>::value) {
+	if (!std::isfinite(value)) return write_null();
+    }
+    if constexpr (sizeof(T) == 1)
+	out << int(value);
+    else
+	out << value;
 }
 
 #endif // LOGS_JSON_DRIVER_H
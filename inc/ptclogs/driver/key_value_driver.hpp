@@ -0,0 +1,57 @@
+#ifndef PTCLOGS_KEY_VALUE_DRIVER_HPP
+#define PTCLOGS_KEY_VALUE_DRIVER_HPP
+#include <string_view>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/value.hpp"
+
+namespace logger {
+/**
+ * @brief Builds the record sections of a driver out of its key and value
+ * primitives.
+ *
+ * Every section is written as write_key followed by a value, so a derived
+ * driver only supplies the record delimiters, the separators and the
+ * primitives used by write_value (write_key, write_string, write_number,
+ * write_bool, write_null, write_raw, begin_array, end_array, begin_object,
+ * end_object and value_separator).
+ *
+ * @tparam Derived Driver deriving from this class.
+ */
+template <class Derived>
+class KeyValueDriver : public IDriver {
+ public:
+  KeyValueDriver(std::ostream& out) : IDriver(out){};
+
+  template <typename T>
+  void print_field(std::string_view header, const T& value) {
+    self().write_key(header);
+    write_value(self(), value);
+  }
+
+  template <typename T>
+  void print_object(const T& object) {
+    print_field(messageKey, object);
+  }
+
+  void print_message(std::string_view message) {
+    self().write_key(messageKey);
+    self().write_string(message);
+  }
+
+  void print_timestamp() {
+    self().write_key(timestampKey);
+    self().write_string(timestamp());
+  }
+
+  void print_level(LogLevel level) {
+    self().write_key(levelKey);
+    self().write_string(level_name(level));
+  }
+
+ private:
+  Derived& self() { return static_cast<Derived&>(*this); }
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_KEY_VALUE_DRIVER_HPP
@@ -0,0 +1,60 @@
+#ifndef PTCLOGS_LOGFMT_DRIVER_HPP
+#define PTCLOGS_LOGFMT_DRIVER_HPP
+#include <cmath>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+
+#include "ptclogs/driver/key_value_driver.hpp"
+
+namespace logger {
+/**
+ * @brief Driver that prints logs as logfmt lines (key=value pairs separated by
+ * spaces). Strings are quoted only when they need to be, nested values are
+ * written compactly so they stay a single token.
+ */
+class LogfmtDriver : public KeyValueDriver<LogfmtDriver> {
+ public:
+  LogfmtDriver(std::ostream& out) : KeyValueDriver(out){};
+  void begin_message() {}
+  void end_message() {}
+  void separator() { out << ' '; }
+  void field_separator() { out << ' '; }
+
+  void begin_array() { out << '['; }
+  void end_array() { out << ']'; }
+  void begin_object() { out << '{'; }
+  void end_object() { out << '}'; }
+  void value_separator() { out << ','; }
+  void write_null() { out << "null"; }
+  void write_bool(bool value) { out << (value ? "true" : "false"); }
+  void write_string(std::string_view value);
+  template <typename K>
+  void write_key(const K& key) { out << key << '='; }
+  template <typename T>
+  void write_number(T value);
+  template <typename T>
+  void write_raw(const T& value);
+};
+};  // namespace logger
+
+/**
+ * @brief Writes what operator<< prints for value as a string, quoted when it
+ * wouldn't stay a single token.
+ */
+template <typename T>
+void logger::LogfmtDriver::write_raw(const T& value) {
+  std::ostringstream text;
+  text << value;
+  write_string(text.view());
+}
+
+template <typename T>
+void logger::LogfmtDriver::write_number(T value) {
+  if constexpr (sizeof(T) == 1)
+    out << int(value);
+  else
+    out << value;
+}
+
+#endif  // PTCLOGS_LOGFMT_DRIVER_HPP
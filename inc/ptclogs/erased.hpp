@@ -0,0 +1,56 @@
+#ifndef PTCLOGS_ERASED_HPP
+#define PTCLOGS_ERASED_HPP
+#include <cstddef>
+
+#include "ptclogs/driver/idriver.hpp"
+
+namespace logger {
+/**
+ * @brief A field lowered to a pointer to it and the writer of its type, so
+ * records are written by one back end per driver instead of one per
+ * combination of field types.
+ *
+ * A call site only stores two pointers per field. The writer is instantiated
+ * once per driver and field type and shared by every site logging that type.
+ * The field has to outlive the ErasedField.
+ *
+ * @tparam Driver Driver that writes the field.
+ */
+template <class Driver>
+struct ErasedField {
+  using Writer = void (*)(Driver& driver, const void* field);
+
+  Writer write;
+  const void* field;
+
+  ErasedField() = default;
+
+  template <typename T>
+  ErasedField(const Field<T>& field) : write(&write_field<T>), field(&field) {}
+
+ private:
+  template <typename T>
+  static void write_field(Driver& driver, const void* field) {
+    const Field<T>& f = *static_cast<const Field<T>*>(field);
+    driver.print_field(f.header, f.value);
+  }
+};
+
+/**
+ * @brief Writes lowered fields, each preceded by the separator it needs. The
+ * counter holds how many fields of the record were written so far.
+ */
+template <class Driver>
+void write_fields(Driver& driver, int& count, const ErasedField<Driver>* fields,
+                  std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) {
+    if (count++)
+      driver.field_separator();
+    else
+      driver.separator();
+    fields[i].write(driver, fields[i].field);
+  }
+}
+};  // namespace logger
+
+#endif  // PTCLOGS_ERASED_HPP
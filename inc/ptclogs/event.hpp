@@ -0,0 +1,125 @@
+#ifndef PTCLOGS_EVENT_HPP
+#define PTCLOGS_EVENT_HPP
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace logger {
+/**
+ * @brief String literal usable as a template argument.
+ */
+template <std::size_t N>
+struct FixedString {
+  constexpr FixedString(const char (&text)[N]) {
+    for (std::size_t i = 0; i < N; i++) data[i] = text[i];
+  }
+  constexpr std::string_view view() const { return {data, N - 1}; }
+  char data[N];
+};
+
+/**
+ * @brief Field of an event schema: its key and the type of its value.
+ */
+template <FixedString Key, typename T>
+struct Slot {
+  using type = T;
+  static constexpr std::string_view key = Key.view();
+};
+
+struct EventTag {};
+
+/**
+ * @brief Record with a fixed message and a fixed list of fields, declared
+ * once as a schema.
+ *
+ * The constant parts of the record, the message and every key with its
+ * separators, are rendered once per driver and copied as bytes on every
+ * call, so logging an event only formats its values.
+ *
+ * Usage:
+ *   using RequestDone = Event<"request done", Slot<"route", std::string_view>,
+ *                             Slot<"status", int>, Slot<"latency_us", long>>;
+ *   logger.INFO(RequestDone("/users", 200, 1234));
+ *
+ * @tparam Name Message of the records.
+ * @tparam Slots Fields of the records, in order.
+ */
+template <FixedString Name, typename... Slots>
+class Event : public EventTag {
+ public:
+  static constexpr std::string_view name = Name.view();
+  static constexpr std::size_t size = sizeof...(Slots);
+  static constexpr std::string_view keys[size + 1] = {Slots::key..., ""};
+
+  Event(typename Slots::type... values) : values(values...) {}
+
+  std::tuple<typename Slots::type...> values;
+};
+
+template <typename T>
+struct is_event : std::is_base_of<EventTag, T> {};
+
+/**
+ * @brief Constant bytes of an event as written by a driver.
+ *
+ * @tparam Driver Driver writing the event, it has to provide write_key.
+ * @tparam E Event schema.
+ */
+template <typename Driver, typename E>
+struct EventLayout {
+  /**
+   * @brief The message section.
+   */
+  std::string message;
+  /**
+   * @brief The first key, preceded by separator when it is the first field
+   * of the record and by field_separator otherwise.
+   */
+  std::string first[2];
+  /**
+   * @brief The other keys, each preceded by field_separator.
+   */
+  std::array<std::string, E::size> keys;
+
+  /**
+   * @brief Returns the layout, rendering it on first use.
+   */
+  static const EventLayout& get() {
+    static const EventLayout layout = render();
+    return layout;
+  }
+
+ private:
+  static EventLayout render() {
+    EventLayout layout;
+    std::ostringstream bytes;
+    Driver driver(bytes);
+    auto take = [&bytes](std::string& into) {
+      into = bytes.str();
+      bytes.str("");
+    };
+    driver.print_message(E::name);
+    take(layout.message);
+    if constexpr (E::size > 0) {
+      driver.separator();
+      driver.write_key(E::keys[0]);
+      take(layout.first[0]);
+      driver.field_separator();
+      driver.write_key(E::keys[0]);
+      take(layout.first[1]);
+      for (std::size_t i = 1; i < E::size; i++) {
+        driver.field_separator();
+        driver.write_key(E::keys[i]);
+        take(layout.keys[i]);
+      }
+    }
+    return layout;
+  }
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_EVENT_HPP
@@ -1,6 +1,23 @@
 #ifndef PTCLOGS_FIELDS_HPP
 #define PTCLOGS_FIELDS_HPP
 #include <sstream>
+#include <string>
+
+#include "ptclogs/driver/idriver.hpp"
+
+namespace logger {
+/**
+ * @brief Returns the kernel id of the calling thread, cached per thread and
+ * read again in the child of a fork.
+ */
+int thread_id();
+
+/**
+ * @brief Returns the cpu the calling thread runs on. It is cached per thread
+ * and refreshed every few calls, so it may briefly lag behind a migration.
+ */
+int cpu_id();
+};  // namespace logger
 
 #define ptclogs_trace()       \
   logger::Field<std::string>( \
@@ -10,4 +27,8 @@
 #define ptclogs_caller() \
   logger::Field<std::string>("caller", __PRETTY_FUNCTION__)
 
+#define ptclogs_thread() logger::Field<int>("tid", logger::thread_id())
+
+#define ptclogs_cpu() logger::Field<int>("cpu", logger::cpu_id())
+
 #endif
@@ -0,0 +1,164 @@
+#ifndef PTCLOGS_FORMAT_HPP
+#define PTCLOGS_FORMAT_HPP
+#include <charconv>
+#include <cstddef>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/memory.hpp"
+#include "ptclogs/value.hpp"
+
+namespace logger {
+template <typename T>
+struct is_field : std::false_type {};
+template <typename T>
+struct is_field<Field<T>> : std::true_type {};
+
+/**
+ * @brief Arguments of a formatted message: values for its placeholders,
+ * optionally mixed with fields. At least one of them has to be a value.
+ */
+template <typename... Args>
+concept FormatArgs = (!is_field<std::remove_cvref_t<Args>>::value || ...);
+
+/**
+ * @brief Message of a logging call and where the call is. It converts from
+ * anything a string_view does, at the call, so where is the caller's.
+ */
+struct Message {
+  template <typename S>
+    requires std::is_convertible_v<const S&, std::string_view>
+  Message(const S& text, std::source_location where = std::source_location::current())
+      : text(text), where(where) {}
+
+  std::string_view text;
+  std::source_location where;
+};
+
+/**
+ * @brief Reports an invalid format string. It is never defined, so calling it
+ * while checking a format string at compile time fails the build.
+ */
+void format_error(const char* reason);
+
+/**
+ * @brief Message format string checked at compile time against the arguments
+ * it is logged with.
+ *
+ * Placeholders are written "{}" and are replaced by the values in order,
+ * "{{" and "}}" stand for literal braces. The number of placeholders has to
+ * match the number of values; fields passed alongside don't count.
+ *
+ * @tparam Args Types of the arguments, fields included.
+ */
+template <typename... Args>
+struct BasicFormat {
+  template <typename S>
+    requires std::is_convertible_v<const S&, std::string_view>
+  consteval BasicFormat(const S& text,
+                        std::source_location where = std::source_location::current())
+      : text(text), where(where) {
+    std::size_t values = (std::size_t(!is_field<std::remove_cvref_t<Args>>::value) + ... + 0);
+    std::size_t placeholders = 0;
+    std::string_view f = this->text;
+    for (std::size_t i = 0; i < f.size(); i++) {
+      if (f[i] == '{') {
+        if (i + 1 < f.size() && f[i + 1] == '{')
+          i++;
+        else if (i + 1 < f.size() && f[i + 1] == '}')
+          i++, placeholders++;
+        else
+          format_error("only {} placeholders are supported, use {{ for a brace");
+      } else if (f[i] == '}') {
+        if (i + 1 < f.size() && f[i + 1] == '}')
+          i++;
+        else
+          format_error("unmatched }, use }} for a brace");
+      }
+    }
+    if (placeholders != values)
+      format_error("the number of {} doesn't match the number of values");
+  }
+
+  std::string_view text;
+  std::source_location where;
+};
+
+template <typename... Args>
+using FormatString = BasicFormat<std::type_identity_t<Args>...>;
+
+/**
+ * @brief Appends the format string from pos up to its next placeholder,
+ * unescaping braces.
+ *
+ * @return Position right after the placeholder, or the size of the format
+ * string when there is none left.
+ */
+inline std::size_t append_literal(std::string& into, std::string_view format,
+                                  std::size_t pos) {
+  std::size_t start = pos;
+  for (; pos < format.size(); pos++) {
+    char c = format[pos];
+    if (c != '{' && c != '}') continue;
+    // the format was checked, so every brace is followed by its pair
+    into.append(format.data() + start, pos - start);
+    if (c == '{' && format[pos + 1] == '}') return pos + 2;
+    into.push_back(c);
+    start = ++pos + 1;
+  }
+  into.append(format.data() + start, format.size() - start);
+  return format.size();
+}
+
+/**
+ * @brief Appends value as text. Strings, numbers, booleans and nullptr are
+ * converted without a stream, Lazy values as what they compute, other types
+ * go through operator<<, which may log on its own.
+ */
+template <typename T>
+void append_value(std::string& into, const T& value) {
+  if constexpr (is_lazy<T>::value) {
+    append_value(into, value.get());
+  } else if constexpr (std::is_null_pointer<T>::value) {
+    into.append("null");
+  } else if constexpr (is_string_like<T>::value) {
+    into.append(std::string_view(value));
+  } else if constexpr (std::is_same<T, bool>::value) {
+    into.append(value ? "true" : "false");
+  } else if constexpr (std::is_same<T, char>::value) {
+    into.push_back(value);
+  } else if constexpr (std::is_arithmetic<T>::value) {
+    char buf[64];
+    auto end = std::to_chars(buf, buf + sizeof buf, value).ptr;
+    into.append(buf, end - buf);
+  } else {
+    memory::Scratch<std::ostringstream> text;
+    text->str("");
+    *text << value;
+    into.append(text->view());
+  }
+}
+
+/**
+ * @brief Appends the message of a format string with its values, skipping
+ * the fields among args.
+ */
+template <typename... Args>
+void format_to(std::string& into, std::string_view format, const Args&... args) {
+  std::size_t pos = 0;
+  auto value = [&](const auto& arg) {
+    if constexpr (!is_field<std::remove_cvref_t<decltype(arg)>>::value) {
+      pos = append_literal(into, format, pos);
+      append_value(into, arg);
+    }
+  };
+  (value(args), ...);
+  append_literal(into, format, pos);
+}
+};  // namespace logger
+
+#endif  // PTCLOGS_FORMAT_HPP
@@ -0,0 +1,132 @@
+#ifndef PTCLOGS_INDEX_HPP
+#define PTCLOGS_INDEX_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Sidecar index of a log file, written by IndexedFileBuffer to <file>.idx.
+ *
+ * The log file is cut in blocks of roughly block_bytes. For every block the
+ * index keeps its byte range, the time span of its records, a bitmap of their
+ * levels and a bloom filter over the values of the indexed keys, so a reader
+ * only has to look at the blocks that may hold what it searches for.
+ *
+ * The index file is an IndexHeader, the indexed keys as newline terminated
+ * strings and one IndexBlock followed by bloom_bits / 8 filter bytes per
+ * block, all in host byte order. Records past the last block, e.g. after a
+ * crash, are not indexed and have to be scanned.
+ */
+namespace logger::index {
+
+constexpr char magic[8] = {'P', 'T', 'C', 'I', 'D', 'X', '1', '\0'};
+
+/**
+ * @brief Settings of an index.
+ */
+struct IndexOptions {
+  /**
+   * @brief Bytes of log after which a block is closed.
+   */
+  std::uint32_t block_bytes = 1 << 16;
+  /**
+   * @brief Bits of the bloom filter of each block, a multiple of 64.
+   */
+  std::uint32_t bloom_bits = 4096;
+  /**
+   * @brief Keys whose values go in the bloom filters, e.g. "request_id".
+   */
+  std::vector<std::string> keys;
+};
+
+struct IndexHeader {
+  char magic[8];
+  std::uint32_t block_bytes;
+  std::uint32_t bloom_bits;
+  std::uint32_t key_count;
+  std::uint32_t keys_size;
+};
+
+struct IndexBlock {
+  std::uint64_t offset;
+  std::uint64_t size;
+  /**
+   * @brief Earliest and latest time of the records of the block, which are
+   * not in time order when some were held back and replayed.
+   */
+  std::int64_t first_ns;
+  std::int64_t last_ns;
+  std::uint32_t records;
+  std::uint32_t levels;
+};
+
+/**
+ * @brief Number of bloom filter bits set per value.
+ */
+constexpr int bloom_hashes = 4;
+
+/**
+ * @brief Hashes a key and value pair for the bloom filters.
+ */
+constexpr std::uint64_t hash(std::string_view key, std::string_view value) {
+  std::uint64_t h = 14695981039346656037ull;
+  for (char c : key) h = (h ^ std::uint8_t(c)) * 1099511628211ull;
+  h = (h ^ '=') * 1099511628211ull;
+  for (char c : value) h = (h ^ std::uint8_t(c)) * 1099511628211ull;
+  return h;
+}
+
+/**
+ * @brief Calls f with the bloom filter bits of a hash.
+ */
+template <typename F>
+void bloom_bits(std::uint64_t h, std::uint32_t bits, F&& f) {
+  std::uint64_t h2 = (h >> 32) | 1;
+  for (int i = 0; i < bloom_hashes; i++) f((h + i * h2) % bits);
+}
+
+/**
+ * @brief Returns the raw value of key in a JSON record, without the quotes of
+ * a string value, or an empty view if the record has no such top level key.
+ * Keys are matched textually, so a nested key of the same name may match.
+ */
+std::string_view find_value(std::string_view record, std::string_view key);
+
+/**
+ * @brief Reads the settings an index at path was written with.
+ *
+ * @return Whether path could be read and is an index.
+ */
+bool load_options(const std::string& path, IndexOptions& options);
+
+/**
+ * @brief Block of a loaded index.
+ */
+struct Block : IndexBlock {
+  std::vector<std::uint64_t> bloom;
+
+  /**
+   * @brief Returns whether the block may hold a record with key=value.
+   */
+  bool may_contain(std::string_view key, std::string_view value) const;
+};
+
+/**
+ * @brief Index loaded from a sidecar file.
+ */
+struct Index {
+  IndexOptions options;
+  std::vector<Block> blocks;
+
+  /**
+   * @brief Loads the index at path.
+   *
+   * @return Whether path could be read and is an index.
+   */
+  bool load(const std::string& path);
+};
+};  // namespace logger::index
+
+#endif  // PTCLOGS_INDEX_HPP
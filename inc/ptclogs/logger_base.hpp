@@ -0,0 +1,174 @@
+#ifndef PTCLOGS_LOGGER_BASE_HPP
+#define PTCLOGS_LOGGER_BASE_HPP
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "ptclogs/context.hpp"
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/erased.hpp"
+#include "ptclogs/event.hpp"
+#include "ptclogs/format.hpp"
+#include "ptclogs/probes.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+#include "ptclogs/telemetry.hpp"
+#include "ptclogs/value.hpp"
+
+namespace logger {
+/**
+ * @brief Record assembly shared by Logger and ProductionLogger.
+ *
+ * Every record is written as timestamp, level, message and then the context
+ * fields followed by the call fields. Records of an object are written as
+ * timestamp, level, the context fields and then the object.
+ *
+ * @tparam Driver Driver that formats the records.
+ * @tparam out Stream the records are written to.
+ */
+template <LogDriver Driver, std::ostream& out>
+class LoggerBase {
+ protected:
+  template <typename... ExtraArgs>
+  LoggerBase(Field<ExtraArgs>... extra) : driver(out), context(Context<Driver>().with(extra...)) {}
+
+  /**
+   * @brief Instantiates a child whose records carry the parent context first.
+   *
+   * @param inherited Context of the parent logger.
+   * @param extra Fields added by the child.
+   */
+  template <typename... ExtraArgs>
+  LoggerBase(const Context<Driver>& inherited, Field<ExtraArgs>... extra)
+      : driver(out), context(inherited.with(extra...)) {}
+
+  template <typename T>
+  void print_object(const T& object, LogLevel level) {
+    ptclogs_probe_write(level, probe_message(object));
+    auto stamp = telemetry::start();
+    set_record_level(level);
+    if constexpr (is_event<T>::value) {
+      begin_record(level);
+      print_event(object);
+    } else {
+      write_object(object, level);
+    }
+    telemetry::record(level, stamp);
+  }
+
+  /**
+   * @brief Prints a record made of message and the fields args. The fields
+   * are lowered to ErasedField, so everything past this call is shared by
+   * every combination of field types.
+   */
+  template <typename... Args>
+  void print_message(std::string_view message, LogLevel level,
+                     const Field<Args>&... args) {
+    const ErasedField<Driver> fields[sizeof...(Args) + 1] = {args...};
+    write_record(message, level, fields, sizeof...(Args));
+  }
+
+  /**
+   * @brief Prints a record whose message is format with its values, followed
+   * by the fields among args. The message is formatted into a per thread
+   * buffer that keeps its capacity, so it doesn't allocate once warm. Values
+   * logging from their operator<< format into buffers of their own.
+   */
+  template <typename... Args>
+  void print_formatted(std::string_view format, LogLevel level, const Args&... args) {
+    memory::Scratch<std::string> message;
+    constexpr std::size_t count = (std::size_t(is_field<Args>::value) + ... + 0);
+    message->clear();
+    format_to(*message, format, args...);
+    ErasedField<Driver> fields[count + 1] = {};
+    std::size_t i = 0;
+    auto lower = [&](const auto& arg) {
+      if constexpr (is_field<std::remove_cvref_t<decltype(arg)>>::value) fields[i++] = arg;
+    };
+    (lower(args), ...);
+    write_record(*message, level, fields, count);
+  }
+
+  Driver driver;
+  Context<Driver> context;
+
+ private:
+  /**
+   * @brief Writes a whole record. It depends on the driver and the stream
+   * only, not on the types of the fields.
+   */
+  void write_record(std::string_view message, LogLevel level,
+                    const ErasedField<Driver>* fields, std::size_t size) {
+    ptclogs_probe_write(level, message);
+    auto stamp = telemetry::start();
+    set_record_level(level);
+    begin_record(level);
+    driver.print_message(message);
+    int count = 0;
+    context.print(driver, out, count);
+    write_fields(driver, count, fields, size);
+    driver.end_message();
+    out << std::endl;
+    telemetry::record(level, stamp);
+  }
+
+  void begin_record(LogLevel level) {
+    driver.begin_message();
+    driver.print_timestamp();
+    driver.separator();
+    driver.print_level(level);
+    driver.separator();
+  }
+
+  /**
+   * @brief Writes a record of an object, which comes after the context
+   * fields.
+   */
+  template <typename T>
+  void write_object(const T& object, LogLevel level) {
+    driver.begin_message();
+    driver.print_timestamp();
+    driver.separator();
+    driver.print_level(level);
+    int count = 0;
+    context.print(driver, out, count);
+    if (count)
+      driver.field_separator();
+    else
+      driver.separator();
+    driver.print_object(object);
+    driver.end_message();
+    out << std::endl;
+  }
+
+  /**
+   * @brief Writes an event from its prerendered layout, formatting only the
+   * values.
+   */
+  template <typename E>
+  void print_event(const E& event) {
+    const auto& layout = EventLayout<Driver, E>::get();
+    out.write(layout.message.data(), layout.message.size());
+    int count = 0;
+    context.print(driver, out, count);
+    if constexpr (E::size > 0) {
+      std::apply(
+          [&](const auto&... values) {
+            std::size_t i = 0;
+            auto slot = [&](const auto& value) {
+              const std::string& key = i ? layout.keys[i] : layout.first[count > 0];
+              out.write(key.data(), key.size());
+              write_value(driver, value);
+              i++;
+            };
+            (slot(values), ...);
+          },
+          event.values);
+    }
+    driver.end_message();
+    out << std::endl;
+  }
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_LOGGER_BASE_HPP
@@ -4,27 +4,45 @@
 #include <functional>
 #include <iostream>
 #include <ostream>
+#include <source_location>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "ptclogs/batch.hpp"
+#include "ptclogs/callsite.hpp"
 #include "ptclogs/driver/console_driver.hpp"
 #include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/logger_base.hpp"
+#include "ptclogs/probes.hpp"
+#include "ptclogs/sampled.hpp"
+#include "ptclogs/timing.hpp"
 
 namespace logger {
 /**
  * @brief Customizeable logger with templated prints.
  */
-template <class Driver = ConsoleDriver, std::ostream& out = std::cout>
-class Logger {
+template <LogDriver Driver = ConsoleDriver, std::ostream& out = std::cout>
+class Logger : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   /**
    * @brief Logs the object t at WARN log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
     if (log_level < LogLevel::WARN) return;
     print_object(t, LogLevel::WARN);
   }
@@ -37,9 +55,28 @@ class Logger {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+    if (log_level < LogLevel::WARN) return;
+    print_message(message.text, LogLevel::WARN, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level. Nothing is formatted when the level is disabled.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
     if (log_level < LogLevel::WARN) return;
-    print_message(message, LogLevel::WARN, args...);
+    print_formatted(format.text, LogLevel::WARN, args...);
   }
 
   /**
@@ -47,9 +84,13 @@ class Logger {
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     if (log_level < LogLevel::FATAL) return;
     print_object(t, LogLevel::FATAL);
     exit(1);
@@ -64,9 +105,29 @@ class Logger {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    if (log_level < LogLevel::FATAL) return;
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1). Nothing is formatted when the level is disabled.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
     if (log_level < LogLevel::FATAL) return;
-    print_message(message, LogLevel::FATAL, args...);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -75,9 +136,13 @@ class Logger {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
     if (log_level < LogLevel::ERROR) return;
     print_object(t, LogLevel::ERROR);
   }
@@ -90,9 +155,28 @@ class Logger {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
     if (log_level < LogLevel::ERROR) return;
-    print_message(message, LogLevel::ERROR, args...);
+    print_message(message.text, LogLevel::ERROR, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level. Nothing is formatted when the level is disabled.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+    if (log_level < LogLevel::ERROR) return;
+    print_formatted(format.text, LogLevel::ERROR, args...);
   }
 
   /**
@@ -100,9 +184,13 @@ class Logger {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
     if (log_level < LogLevel::INFO) return;
     print_object(t, LogLevel::INFO);
   }
@@ -115,9 +203,28 @@ class Logger {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+    if (log_level < LogLevel::INFO) return;
+    print_message(message.text, LogLevel::INFO, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level. Nothing is formatted when the level is disabled.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
     if (log_level < LogLevel::INFO) return;
-    print_message(message, LogLevel::INFO, args...);
+    print_formatted(format.text, LogLevel::INFO, args...);
   }
 
   /**
@@ -125,9 +232,13 @@ class Logger {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
     if (log_level < LogLevel::DEBUG) return;
     print_object(t, LogLevel::DEBUG);
   }
@@ -140,8 +251,41 @@ class Logger {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
     if (log_level < LogLevel::DEBUG) return;
+    print_message(message.text, LogLevel::DEBUG, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level. Nothing is formatted when the level is disabled.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
+    if (log_level < LogLevel::DEBUG) return;
+    print_formatted(format.text, LogLevel::DEBUG, args...);
+  }
+
+  /**
+   * @brief Logs the message with its fields at DEBUG log level if the call
+   * site is enabled. Called by ptclogs_debug.
+   *
+   * @param site Call site of the statement.
+   * @param message Message that will be printed.
+   * @param args Fields that will be printed alongside the message.
+   */
+  template <typename... Args>
+  void DEBUG(CallSite& site, std::string_view message, Field<Args>... args) {
+    if (!site.enabled(log_level)) return;
     print_message(message, LogLevel::DEBUG, args...);
   }
 
@@ -160,95 +304,78 @@ class Logger {
   LogLevel GetLogLevel() { return log_level; };
 
   template <typename... ExtraArgs>
-  Logger( Field<ExtraArgs>... extra)
-      : driver(out), extraFunctions() {
+  Logger(Field<ExtraArgs>... extra) : Base(extra...) {
     log_level = LogLevel::INFO;
     if (getenv("VERBOSITY") != NULL)
       log_level = LogLevel(atoi(getenv("VERBOSITY")));
-
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
   }
 
   template <typename... ExtraArgs>
-  Logger(LogLevel log_level,
-         Field<ExtraArgs>... extra)
-      : log_level(log_level), driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  Logger(LogLevel log_level, Field<ExtraArgs>... extra)
+      : Base(extra...), log_level(log_level) {}
 
+  /**
+   * @brief Returns a child logger whose records carry the given fields after
+   * the fields of this logger.
+   *
+   * @param extra Fields added to every record of the child.
+   */
   template <typename... ExtraArgs>
   Logger<Driver, out> With(Field<ExtraArgs>... extra) {
-    return Logger<Driver, out>(log_level,  extraFunctions, extra...);
+    return Logger<Driver, out>(log_level, this->context, extra...);
   }
 
- private:
+  /**
+   * @brief Returns a child logger for one request, which holds back the
+   * records this logger's level filters out and writes them when the request
+   * ends only if the policy keeps it.
+   *
+   * @param policy When to write the held back records.
+   * @param extra Fields added to every record of the child, e.g. the request
+   * id.
+   */
   template <typename... ExtraArgs>
-  Logger(LogLevel log_level,
-         std::vector<std::function<void()>> _extraFunctions,
-         Field<ExtraArgs>... extra)
-      : Logger(log_level,  extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
+  SampledLogger<Driver, out> Sampled(SamplingPolicy policy, Field<ExtraArgs>... extra) {
+    return SampledLogger<Driver, out>(log_level, policy, this->context, extra...);
   }
 
-  Driver driver;
-  LogLevel log_level;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
-  }
-
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
+  /**
+   * @brief Returns a batch of records with this logger's level and fields,
+   * written together when it is committed or goes out of scope.
+   *
+   * @param options How the records of the batch are stamped.
+   */
+  LogBatch<Driver, out> Batch(BatchOptions options = {}) {
+    return LogBatch<Driver, out>(log_level, this->context, options);
   }
 
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
+  /**
+   * @brief Returns a timer that logs message at INFO with the given fields
+   * and duration_ns when it goes out of scope.
+   */
+  template <typename... Args>
+  ScopedTimer<Logger<Driver, out>, Args...> Time(std::string message, Field<Args>... fields) {
+    return Time(LogLevel::INFO, std::move(message), fields...);
   }
 
+  /**
+   * @brief Returns a timer that logs message at level with the given fields
+   * and duration_ns when it goes out of scope.
+   */
   template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
+  ScopedTimer<Logger<Driver, out>, Args...> Time(LogLevel level, std::string message,
+                                                 Field<Args>... fields) {
+    return ScopedTimer<Logger<Driver, out>, Args...>(*this, level, std::move(message), fields...);
   }
 
+ private:
+  template <typename... ExtraArgs>
+  Logger(LogLevel log_level,
+         const Context<Driver>& inherited,
+         Field<ExtraArgs>... extra)
+      : Base(inherited, extra...), log_level(log_level) {}
 
-  std::function<void()> extraArgs;
+  LogLevel log_level;
 };
 
 };  // namespace logger
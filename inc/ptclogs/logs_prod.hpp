@@ -3,26 +3,33 @@
 #include <functional>
 #include <iostream>
 #include <ostream>
+#include <source_location>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "ptclogs/driver/idriver.hpp"
 #include "ptclogs/driver/json_driver.hpp"
+#include "ptclogs/logger_base.hpp"
+#include "ptclogs/probes.hpp"
 namespace logger {
-template <class Driver = JSONDriver, LogLevel log_level = LogLevel::INFO,
+template <LogDriver Driver = JSONDriver, LogLevel log_level = LogLevel::INFO,
           std::ostream& out = std::cout>
 class ProductionLogger {};
-template <typename Driver, std::ostream& out>
-class ProductionLogger<Driver, LogLevel::INFO, out> {
+template <LogDriver Driver, std::ostream& out>
+class ProductionLogger<Driver, LogLevel::INFO, out> : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   template <typename... ExtraArgs>
-  ProductionLogger(Field<ExtraArgs>... extra) : driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  ProductionLogger(Field<ExtraArgs>... extra) : Base(extra...) {}
 
   template <typename... ExtraArgs>
   ProductionLogger<Driver, LogLevel::INFO, out> With(Field<ExtraArgs>... extra) {
-    return ProductionLogger<Driver, LogLevel::INFO, out>(extraFunctions, extra...);
+    return ProductionLogger<Driver, LogLevel::INFO, out>(this->context, extra...);
   }
 
   /**
@@ -30,9 +37,13 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
     print_object(t, LogLevel::WARN);
   }
 
@@ -44,8 +55,26 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::WARN, args...);
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+    print_message(message.text, LogLevel::WARN, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
+    print_formatted(format.text, LogLevel::WARN, args...);
   }
 
   /**
@@ -53,9 +82,13 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     print_object(t, LogLevel::FATAL);
     exit(1);
   }
@@ -69,8 +102,27 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::FATAL, args...);
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1).
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -79,9 +131,13 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
     print_object(t, LogLevel::ERROR);
   }
 
@@ -93,8 +149,26 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::ERROR, args...);
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
+    print_message(message.text, LogLevel::ERROR, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+    print_formatted(format.text, LogLevel::ERROR, args...);
   }
 
   /**
@@ -102,9 +176,13 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
     print_object(t, LogLevel::INFO);
   }
 
@@ -116,8 +194,26 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::INFO, args...);
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+    print_message(message.text, LogLevel::INFO, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
+    print_formatted(format.text, LogLevel::INFO, args...);
   }
 
   /**
@@ -125,9 +221,14 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t){};
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
+  }
   /**
    * @brief Logs the message with its fields at DEBUG log level.
    *
@@ -136,96 +237,59 @@ class ProductionLogger<Driver, LogLevel::INFO, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {}
-
- private:
-  template <typename... ExtraArgs>
-  ProductionLogger(
-                   std::vector<std::function<void()>> _extraFunctions,
-                   Field<ExtraArgs>... extra)
-      : ProductionLogger(extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
-  }
-
-  Driver driver;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
   }
 
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
   }
 
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  std::function<void()> extraArgs;
+ private:
+  template <typename... ExtraArgs>
+  ProductionLogger(const Context<Driver>& inherited,
+                   Field<ExtraArgs>... extra)
+      : Base(inherited, extra...) {}
 };
-template <typename Driver, std::ostream& out>
-class ProductionLogger<Driver, LogLevel::DEBUG, out> {
+template <LogDriver Driver, std::ostream& out>
+class ProductionLogger<Driver, LogLevel::DEBUG, out> : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   template <typename... ExtraArgs>
-  ProductionLogger(Field<ExtraArgs>... extra) : driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  ProductionLogger(Field<ExtraArgs>... extra) : Base(extra...) {}
 
   template <typename... ExtraArgs>
-  ProductionLogger<Driver, LogLevel::DEBUG, out> With(
-      Field<ExtraArgs>... extra) {
-    return ProductionLogger<Driver, LogLevel::DEBUG, out>(extraFunctions,
-                                                          extra...);
+  ProductionLogger<Driver, LogLevel::DEBUG, out> With(Field<ExtraArgs>... extra) {
+    return ProductionLogger<Driver, LogLevel::DEBUG, out>(this->context, extra...);
   }
   /**
    * @brief Logs the object t at WARN log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
     print_object(t, LogLevel::WARN);
   }
 
@@ -237,8 +301,26 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::WARN, args...);
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+    print_message(message.text, LogLevel::WARN, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
+    print_formatted(format.text, LogLevel::WARN, args...);
   }
 
   /**
@@ -246,9 +328,13 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     print_object(t, LogLevel::FATAL);
     exit(1);
   }
@@ -262,8 +348,27 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::FATAL, args...);
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1).
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -272,9 +377,13 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
     print_object(t, LogLevel::ERROR);
   }
 
@@ -286,8 +395,26 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::ERROR, args...);
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
+    print_message(message.text, LogLevel::ERROR, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+    print_formatted(format.text, LogLevel::ERROR, args...);
   }
 
   /**
@@ -295,9 +422,13 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
     print_object(t, LogLevel::INFO);
   }
 
@@ -309,8 +440,26 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::INFO, args...);
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+    print_message(message.text, LogLevel::INFO, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
+    print_formatted(format.text, LogLevel::INFO, args...);
   }
 
   /**
@@ -318,9 +467,13 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
     print_object(t, LogLevel::DEBUG);
   }
 
@@ -332,97 +485,62 @@ class ProductionLogger<Driver, LogLevel::DEBUG, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::DEBUG, args...);
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
+    print_message(message.text, LogLevel::DEBUG, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
+    print_formatted(format.text, LogLevel::DEBUG, args...);
   }
 
  private:
   template <typename... ExtraArgs>
-  ProductionLogger(std::vector<std::function<void()>> _extraFunctions,
+  ProductionLogger(const Context<Driver>& inherited,
                    Field<ExtraArgs>... extra)
-      : ProductionLogger(extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
-  }
-
-  Driver driver;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
-  }
-
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
-  }
-
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  std::function<void()> extraArgs;
+      : Base(inherited, extra...) {}
 };
-template <typename Driver, std::ostream& out>
-class ProductionLogger<Driver, LogLevel::ERROR, out> {
+template <LogDriver Driver, std::ostream& out>
+class ProductionLogger<Driver, LogLevel::ERROR, out> : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   template <typename... ExtraArgs>
-  ProductionLogger(Field<ExtraArgs>... extra)
-      : driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  ProductionLogger(Field<ExtraArgs>... extra) : Base(extra...) {}
 
   template <typename... ExtraArgs>
   ProductionLogger<Driver, LogLevel::ERROR, out> With(Field<ExtraArgs>... extra) {
-    return ProductionLogger<Driver, LogLevel::ERROR, out>( extraFunctions,
-                                                     extra...);
+    return ProductionLogger<Driver, LogLevel::ERROR, out>(this->context, extra...);
   }
   /**
    * @brief Logs the object t at WARN log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at WARN log level.
@@ -432,16 +550,38 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {}
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at FATAL log level and calls exit(1).
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     print_object(t, LogLevel::FATAL);
     exit(1);
   }
@@ -455,8 +595,27 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::FATAL, args...);
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1).
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -465,9 +624,13 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
     print_object(t, LogLevel::ERROR);
   }
 
@@ -479,8 +642,26 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::ERROR, args...);
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
+    print_message(message.text, LogLevel::ERROR, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+    print_formatted(format.text, LogLevel::ERROR, args...);
   }
 
   /**
@@ -488,9 +669,14 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at INFO log level.
@@ -500,16 +686,39 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {}
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at DEBUG log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at DEBUG log level.
@@ -519,97 +728,60 @@ class ProductionLogger<Driver, LogLevel::ERROR, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {}
-
- private:
-  template <typename... ExtraArgs>
-  ProductionLogger(
-                   std::vector<std::function<void()>> _extraFunctions,
-                   Field<ExtraArgs>... extra)
-      : ProductionLogger( extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
   }
 
-  Driver driver;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
-  }
-
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
   }
 
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
-  }
-
-
-  std::function<void()> extraArgs;
+ private:
+  template <typename... ExtraArgs>
+  ProductionLogger(const Context<Driver>& inherited,
+                   Field<ExtraArgs>... extra)
+      : Base(inherited, extra...) {}
 };
-template <typename Driver, std::ostream& out>
-class ProductionLogger<Driver, LogLevel::FATAL, out> {
+template <LogDriver Driver, std::ostream& out>
+class ProductionLogger<Driver, LogLevel::FATAL, out> : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   template <typename... ExtraArgs>
-  ProductionLogger(Field<ExtraArgs>... extra)
-      :  driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  ProductionLogger(Field<ExtraArgs>... extra) : Base(extra...) {}
 
   template <typename... ExtraArgs>
   ProductionLogger<Driver, LogLevel::FATAL, out> With(Field<ExtraArgs>... extra) {
-    return ProductionLogger<Driver, LogLevel::FATAL, out>( extraFunctions,
-                                                     extra...);
+    return ProductionLogger<Driver, LogLevel::FATAL, out>(this->context, extra...);
   }
   /**
    * @brief Logs the object t at WARN log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at WARN log level.
@@ -619,16 +791,38 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {}
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at FATAL log level and calls exit(1).
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     print_object(t, LogLevel::FATAL);
     exit(1);
   }
@@ -642,8 +836,27 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::FATAL, args...);
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1).
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -652,9 +865,14 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at ERROR log level.
@@ -664,16 +882,39 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {}
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at INFO log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at INFO log level.
@@ -683,16 +924,39 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {}
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at DEBUG log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at DEBUG log level.
@@ -702,97 +966,59 @@ class ProductionLogger<Driver, LogLevel::FATAL, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {}
-
- private:
-  template <typename... ExtraArgs>
-  ProductionLogger(
-                   std::vector<std::function<void()>> _extraFunctions,
-                   Field<ExtraArgs>... extra)
-      : ProductionLogger( extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
   }
 
-  Driver driver;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
-  }
-
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
   }
 
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
-  }
-
-
-  std::function<void()> extraArgs;
+ private:
+  template <typename... ExtraArgs>
+  ProductionLogger(const Context<Driver>& inherited,
+                   Field<ExtraArgs>... extra)
+      : Base(inherited, extra...) {}
 };
-template <typename Driver, std::ostream& out>
-class ProductionLogger<Driver, LogLevel::WARN, out> {
+template <LogDriver Driver, std::ostream& out>
+class ProductionLogger<Driver, LogLevel::WARN, out> : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+  using Base::print_message;
+  using Base::print_object;
+  using Base::print_formatted;
+
  public:
   template <typename... ExtraArgs>
-  ProductionLogger( Field<ExtraArgs>... extra)
-      : driver(out) {
-    extraArgs = [this, extra...]() { printv(extra...); };
-    extraFunctions.push_back(extraArgs);
-  }
+  ProductionLogger(Field<ExtraArgs>... extra) : Base(extra...) {}
 
   template <typename... ExtraArgs>
   ProductionLogger<Driver, LogLevel::WARN, out> With(Field<ExtraArgs>... extra) {
-    return ProductionLogger<Driver, LogLevel::WARN, out>( extraFunctions,
-                                                    extra...);
+    return ProductionLogger<Driver, LogLevel::WARN, out>(this->context, extra...);
   }
   /**
    * @brief Logs the object t at WARN log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void WARN(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void WARN(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::WARN, where, probe_message(t));
     print_object(t, LogLevel::WARN);
   }
 
@@ -804,8 +1030,26 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void WARN(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::WARN, args...);
+  void WARN(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::WARN, message.where, message.text);
+    print_message(message.text, LogLevel::WARN, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at WARN log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::WARN, format.where, format.text);
+    print_formatted(format.text, LogLevel::WARN, args...);
   }
 
   /**
@@ -813,9 +1057,13 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    *
    * @tparam T Type of the object that will be printed.
    * @param t Object that will be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void FATAL(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void FATAL(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::FATAL, where, probe_message(t));
     print_object(t, LogLevel::FATAL);
     exit(1);
   }
@@ -829,8 +1077,27 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void FATAL(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::FATAL, args...);
+  void FATAL(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::FATAL, message.where, message.text);
+    print_message(message.text, LogLevel::FATAL, args...);
+    exit(1);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at FATAL log
+   * level and calls exit(1).
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::FATAL, format.where, format.text);
+    print_formatted(format.text, LogLevel::FATAL, args...);
     exit(1);
   }
 
@@ -839,9 +1106,13 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void ERROR(T t) {
+    requires(!std::is_same<T, std::string_view>::value)
+  void ERROR(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::ERROR, where, probe_message(t));
     print_object(t, LogLevel::ERROR);
   }
 
@@ -853,8 +1124,26 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void ERROR(std::string message, Field<Args>... args) {
-    print_message(message, LogLevel::ERROR, args...);
+  void ERROR(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::ERROR, message.where, message.text);
+    print_message(message.text, LogLevel::ERROR, args...);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at ERROR log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::ERROR, format.where, format.text);
+    print_formatted(format.text, LogLevel::ERROR, args...);
   }
 
   /**
@@ -862,9 +1151,14 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void INFO(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void INFO(T t,
+            std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::INFO, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at INFO log level.
@@ -874,16 +1168,39 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void INFO(std::string message, Field<Args>... args) {}
+  void INFO(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::INFO, message.where, message.text);
+  }
+
+  /**
+   * @brief Logs a message formatted from format and its values at INFO log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::INFO, format.where, format.text);
+  }
 
   /**
    * @brief Logs the object t at DEBUG log level.
    *
    * @tparam T Type of the object to be printed.
    * @param t Object to be printed.
+   * @param where Place of the call, which tells it apart in the probes.
    */
   template <typename T>
-  void DEBUG(T t) {}
+    requires(!std::is_same<T, std::string_view>::value)
+  void DEBUG(T t,
+             std::source_location where = std::source_location::current()) {
+    ptclogs_probe_log(LogLevel::DEBUG, where, probe_message(t));
+  }
 
   /**
    * @brief Logs the message with its fields at DEBUG log level.
@@ -893,73 +1210,31 @@ class ProductionLogger<Driver, LogLevel::WARN, out> {
    * @param args Fields that will be printed alongside the message.
    */
   template <typename... Args>
-  void DEBUG(std::string message, Field<Args>... args) {}
-
- private:
-  template <typename... ExtraArgs>
-  ProductionLogger(
-                   std::vector<std::function<void()>> _extraFunctions,
-                   Field<ExtraArgs>... extra)
-      : ProductionLogger( extra...) {
-    for (auto f : _extraFunctions) {
-      extraFunctions.push_back(f);
-    }
+  void DEBUG(Message message, Field<Args>... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, message.where, message.text);
   }
 
-  Driver driver;
-  void printv() {}
-  template <typename T>
-  void printv(Field<T> field) {
-    driver.print_field(field.header, field.value);
-  }
-
-  template <typename T, typename... Args>
-  void printv(Field<T> field,
-              Field<Args>... args)  // recursive variadic function
-  {
-    driver.print_field(field.header, field.value);
-    driver.field_separator();
-    printv(args...);
+  /**
+   * @brief Logs a message formatted from format and its values at DEBUG log
+   * level.
+   *
+   * @tparam Args Types of the values, optionally mixed with fields.
+   * @param format Message with a {} placeholder per value, checked at
+   * compile time.
+   * @param args Values of the placeholders, in order, and fields that will
+   * be printed alongside the message.
+   */
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    ptclogs_probe_log(LogLevel::DEBUG, format.where, format.text);
   }
 
-  std::vector<std::function<void()>> extraFunctions;
-
-  template <typename T>
-  void print_object(T object, LogLevel level) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    driver.print_object(object);
-    driver.end_message();
-    out << std::endl;
-  }
-
-  template <typename... Args>
-  void print_message(std::string message, LogLevel level, Field<Args>... args) {
-    driver.begin_message();
-    driver.print_timestamp();
-    driver.separator();
-    driver.print_level(level);
-    driver.separator();
-    driver.print_message(message);
-    driver.separator();
-    for (auto& f : extraFunctions) {
-      f();
-      driver.field_separator();
-    }
-    printv(args...);
-    driver.end_message();
-    out << std::endl;
-  }
-
-
-  std::function<void()> extraArgs;
+ private:
+  template <typename... ExtraArgs>
+  ProductionLogger(const Context<Driver>& inherited,
+                   Field<ExtraArgs>... extra)
+      : Base(inherited, extra...) {}
 };
 };  // namespace logger
 #endif
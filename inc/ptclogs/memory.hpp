@@ -0,0 +1,106 @@
+#ifndef PTCLOGS_MEMORY_HPP
+#define PTCLOGS_MEMORY_HPP
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+
+/**
+ * Memory the library allocates for itself: arena blocks of sampled loggers,
+ * rendered contexts of child loggers and records queued by the buffered
+ * sinks. It all comes from one std::pmr::memory_resource, by default a pool
+ * over the global heap, and is counted so logging memory can be bounded.
+ *
+ * Buffers reused by every record, like the per thread staging strings, are
+ * allocated once and don't go through the resource.
+ */
+namespace logger::memory {
+
+/**
+ * @brief Returns the resource the library allocates from. Allocations made
+ * through it are counted in usage.
+ */
+std::pmr::memory_resource* resource();
+
+/**
+ * @brief Makes the library allocate from upstream from now on. Memory
+ * allocated before keeps going back to the resource it came from, so upstream
+ * and the previous resources must outlive the loggers using them.
+ *
+ * @param upstream Resource to allocate from, e.g. a resource of the
+ * application's allocator or a monotonic buffer. nullptr restores the
+ * default pool.
+ */
+void set_resource(std::pmr::memory_resource* upstream);
+
+/**
+ * @brief Memory held by the library, in bytes.
+ */
+struct Usage {
+  /**
+   * @brief Allocated from the resource and not yet returned.
+   */
+  std::uint64_t in_use = 0;
+  std::uint64_t high_water = 0;
+  std::uint64_t allocations = 0;
+  /**
+   * @brief Held by arenas, out of in_use. Blocks kept by the per thread pools
+   * for reuse are in pooled.
+   */
+  std::uint64_t arena_in_use = 0;
+  std::uint64_t arena_high_water = 0;
+  std::uint64_t pooled = 0;
+};
+
+/**
+ * @brief Returns the current usage.
+ */
+Usage usage();
+
+/**
+ * @brief Restarts the high-water marks from the current usage.
+ */
+void reset_high_water();
+
+/**
+ * @brief Counts arena blocks taken from or given back to the pools.
+ */
+void arena_acquired(std::size_t bytes);
+void arena_released(std::size_t bytes);
+
+/**
+ * @brief Counts blocks entering or leaving the per thread pools.
+ */
+void pooled(std::int64_t bytes);
+
+/**
+ * @brief A per thread T lent to one call and reused by the next call at the
+ * same depth, so it keeps its capacity. A call nested in another on the same
+ * thread, like a value whose operator<< logs, borrows a T of its own instead
+ * of the one its caller is still using.
+ */
+template <typename T>
+class Scratch {
+ public:
+  Scratch() : value(borrow()) {}
+  ~Scratch() { depth--; }
+  Scratch(const Scratch&) = delete;
+  Scratch& operator=(const Scratch&) = delete;
+
+  T& operator*() const { return value; }
+  T* operator->() const { return &value; }
+
+ private:
+  static T& borrow() {
+    // a deque doesn't move the Ts still lent out when it grows
+    static thread_local std::deque<T> values;
+    if (depth == values.size()) values.emplace_back();
+    return values[depth++];
+  }
+
+  static inline thread_local std::size_t depth = 0;
+  T& value;
+};
+};  // namespace logger::memory
+
+#endif  // PTCLOGS_MEMORY_HPP
@@ -0,0 +1,93 @@
+#ifndef PTCLOGS_PROBES_HPP
+#define PTCLOGS_PROBES_HPP
+
+/**
+ * USDT probes, for tracing log statements with perf, bpftrace or systemtap
+ * whether or not their records are written.
+ *
+ * They are compiled in when PTCLOGS_USDT is defined (make USDT=1 for the
+ * library, -DPTCLOGS_USDT for code including the headers) and need
+ * sys/sdt.h. An untraced probe is a single nop, and without PTCLOGS_USDT
+ * they expand to nothing. The provider is ptclogs:
+ *
+ * - log(level, site, message, length, file, line) at every logging call of
+ *   Logger and ProductionLogger, before the level is checked, so disabled
+ *   statements fire it too. site identifies the statement: it is the
+ *   std::source_location the call was made with, as a pointer, so a logging
+ *   method that isn't inlined still tells its callers apart. ptclogs_debug
+ *   statements pass their CallSite instead, and no message, which isn't
+ *   evaluated while the site is disabled. Records logged as objects only
+ *   have one when the object is a string.
+ * - write(level, message, length) when a record is written.
+ *
+ * Usage:
+ *   bpftrace -e 'usdt:./server:ptclogs:log /arg0 == 4/ {
+ *     @[str(arg4), arg5, str(arg2, arg3)] = count(); }'
+ */
+#ifdef PTCLOGS_USDT
+#include <sys/sdt.h>
+
+#include <cstring>
+#include <source_location>
+#include <string_view>
+#include <type_traits>
+
+namespace logger {
+/**
+ * @brief Returns the message probes pass for a record logged as an object:
+ * the object itself when it is a string.
+ */
+template <typename T>
+std::string_view probe_message(const T& object) {
+  if constexpr (std::is_convertible<const T&, std::string_view>::value &&
+                !std::is_null_pointer<T>::value)
+    return object;
+  else
+    return {};
+}
+
+/**
+ * @brief Returns the id probes pass for the call site at where. A
+ * source_location holds nothing but the address of the constant the
+ * compiler emits for its current() call, in libstdc++ and libc++ alike, and
+ * that address is distinct per call site.
+ */
+inline const void* probe_site(const std::source_location& where) {
+  static_assert(sizeof where == sizeof(const void*));
+  const void* site;
+  std::memcpy(&site, &where, sizeof site);
+  return site;
+}
+};  // namespace logger
+
+#define ptclogs_probe_log(level, where, message)                                 \
+  ptclogs_probe_log_at(level, logger::probe_site(where), (where).file_name(),    \
+                       (where).line(), message)
+
+#define ptclogs_probe_log_at(level, site, file, line, message)                   \
+  do {                                                                           \
+    std::string_view ptclogs_text{message};                                      \
+    STAP_PROBE6(ptclogs, log, int(level), static_cast<const void*>(site),        \
+                ptclogs_text.data(), ptclogs_text.size(),                        \
+                static_cast<const char*>(file), int(line));                      \
+  } while (0)
+
+#define ptclogs_probe_write(level, message)                                      \
+  do {                                                                           \
+    std::string_view ptclogs_text{message};                                      \
+    STAP_PROBE3(ptclogs, write, int(level), ptclogs_text.data(),                 \
+                ptclogs_text.size());                                            \
+  } while (0)
+#else
+#define ptclogs_probe_log(level, where, message) \
+  do {                                           \
+  } while (0)
+#define ptclogs_probe_log_at(level, site, file, line, message) \
+  do {                                                         \
+  } while (0)
+#define ptclogs_probe_write(level, message) \
+  do {                                      \
+  } while (0)
+#endif
+
+#endif  // PTCLOGS_PROBES_HPP
@@ -0,0 +1,186 @@
+#ifndef PTCLOGS_READER_HPP
+#define PTCLOGS_READER_HPP
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ptclogs/driver/idriver.hpp"
+
+/**
+ * Reading of files written by JSONDriver and ConsoleDriver.
+ *
+ * Files are memory mapped and records are handed out as views into the
+ * mapping, nothing is copied. String values are left escaped, use unescape
+ * when the exact text is needed.
+ */
+namespace logger::reader {
+
+enum class Format { JSON, CONSOLE };
+
+/**
+ * @brief Field of a record. A string value is given without its quotes.
+ */
+struct Field {
+  std::string_view key;
+  std::string_view value;
+  bool quoted;
+};
+
+/**
+ * @brief One record, as views into its line.
+ */
+struct Record {
+  std::string_view line;
+  std::string_view ts;
+  std::string_view level;
+  std::string_view msg;
+  /**
+   * @brief Text of the fields following the fixed sections.
+   */
+  std::string_view fields;
+  Format format;
+
+  /**
+   * @brief Calls f with every field of the record, in order.
+   */
+  template <typename F>
+  void for_each_field(F&& f) const;
+
+  /**
+   * @brief Returns the value of the field key, or an empty view if there is
+   * none.
+   */
+  std::string_view get(std::string_view key) const;
+
+  /**
+   * @brief Parses the level section.
+   *
+   * @return Whether the level is valid.
+   */
+  bool level_value(LogLevel& value) const { return parse_level(level, value); }
+};
+
+/**
+ * @brief Returns the first newline in [begin, end), or end. Scans 16 bytes
+ * at a time with SSE2 where available.
+ */
+const char* find_newline(const char* begin, const char* end);
+
+/**
+ * @brief Parses a line without its newline.
+ *
+ * JSON lines starting with the sections in the order drivers write them
+ * ({"ts":..,"level":..,"msg":..) take a fast path; other JSON objects are
+ * searched for those keys.
+ *
+ * @return Whether the line is a record of the given format.
+ */
+bool parse(std::string_view line, Format format, Record& record);
+
+/**
+ * @brief Returns the ts section of a line, parsing nothing else when the
+ * line starts with it.
+ */
+std::string_view timestamp(std::string_view line, Format format);
+
+/**
+ * @brief Reads the field at the start of text and advances text past it.
+ *
+ * @return Whether there was a field.
+ */
+bool next_field(std::string_view& text, Format format, Field& field);
+
+/**
+ * @brief Returns the text of an escaped JSON string value.
+ */
+std::string unescape(std::string_view value);
+
+/**
+ * @brief Guesses the format of a file from its first line.
+ */
+Format detect(std::string_view data);
+
+/**
+ * @brief Splits data in at most parts ranges ending on line boundaries.
+ */
+std::vector<std::string_view> split(std::string_view data, std::size_t parts);
+
+/**
+ * @brief Calls f with every line of data, without its newline.
+ */
+template <typename F>
+void for_each_line(std::string_view data, F&& f) {
+  const char* p = data.data();
+  const char* end = p + data.size();
+  while (p < end) {
+    const char* nl = find_newline(p, end);
+    f(std::string_view(p, nl - p));
+    p = nl + 1;
+  }
+}
+
+/**
+ * @brief Calls f with every record of data. Lines that don't parse are
+ * skipped.
+ */
+template <typename F>
+void scan(std::string_view data, Format format, F&& f) {
+  Record record;
+  for_each_line(data, [&](std::string_view line) {
+    if (parse(line, format, record)) f(record);
+  });
+}
+
+/**
+ * @brief Scans data split across threads. f is called concurrently as
+ * f(part, record), where part is the index of the range the record is in,
+ * and records of a part are in file order.
+ */
+template <typename F>
+void parallel_scan(std::string_view data, Format format, unsigned threads, F&& f) {
+  std::vector<std::string_view> parts = split(data, threads ? threads : 1);
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < parts.size(); i++)
+    workers.emplace_back([&, i] {
+      scan(parts[i], format, [&](const Record& record) { f(i, record); });
+    });
+  if (!parts.empty())
+    scan(parts[0], format, [&](const Record& record) { f(std::size_t(0), record); });
+  for (auto& worker : workers) worker.join();
+}
+
+/**
+ * @brief Read only memory mapping of a whole file.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  /**
+   * @brief Maps the file at path, replacing the current mapping.
+   *
+   * @return Whether the file could be mapped.
+   */
+  bool open(const std::string& path);
+
+  std::string_view data() const { return {begin, size}; }
+
+ private:
+  const char* begin = nullptr;
+  std::size_t size = 0;
+};
+
+template <typename F>
+void Record::for_each_field(F&& f) const {
+  std::string_view rest = fields;
+  Field field;
+  while (next_field(rest, format, field)) f(field);
+}
+};  // namespace logger::reader
+
+#endif  // PTCLOGS_READER_HPP
@@ -0,0 +1,350 @@
+#ifndef PTCLOGS_SAMPLED_HPP
+#define PTCLOGS_SAMPLED_HPP
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ptclogs/arena.hpp"
+#include "ptclogs/clock.hpp"
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/logger_base.hpp"
+
+namespace logger {
+/**
+ * @brief Decides when the held back records of a request are written.
+ */
+struct SamplingPolicy {
+  /**
+   * @brief A record at this level or a more severe one keeps the request.
+   */
+  LogLevel trigger = LogLevel::ERROR;
+  /**
+   * @brief A request that lives longer than this is kept.
+   */
+  std::chrono::nanoseconds latency = std::chrono::nanoseconds::max();
+};
+
+/**
+ * @brief Request scoped logger that holds back the records its level filters
+ * out and writes them only if the request turns out to be interesting.
+ *
+ * Records the level lets through are written right away, as with Logger. The
+ * others are captured unformatted in an arena from a per thread pool: the
+ * message and the text of string_view and C string fields are copied into
+ * it, other fields, std::string ones included, are moved. Objects logged on
+ * their own are captured the same way. Formatted messages keep a copy of
+ * their values, with string_view and C string text in the arena too, and
+ * are formatted only if written. C strings are char pointers, const or not,
+ * and char arrays. So on the common path of a
+ * request that succeeds quickly, capturing does no formatting and, once the
+ * pool is warm, no heap allocation beyond what the caller did to build its
+ * fields or what copying a std::string value takes. When the logger is
+ * destroyed, the captured records are written in order with the time they
+ * were logged at if a record reached the policy trigger, the request took
+ * longer than the latency threshold or Keep was called, and are
+ * dropped otherwise.
+ *
+ * Usage:
+ *   auto req = logger.Sampled({.latency = 250ms}, Field("request_id", id));
+ *   req.DEBUG("cache miss", Field("key", key));  // held back
+ *   req.ERROR("upstream failed");  // written, and so is "cache miss" at scope end
+ */
+template <LogDriver Driver, std::ostream& out>
+class SampledLogger : public LoggerBase<Driver, out> {
+  using Base = LoggerBase<Driver, out>;
+
+ public:
+  /**
+   * @brief Instantiates a request logger. Use Logger::Sampled instead.
+   *
+   * @param log_level Level of the records written right away.
+   * @param policy When to write the held back records.
+   * @param inherited Context of the parent logger.
+   * @param extra Fields identifying the request.
+   */
+  template <typename... ExtraArgs>
+  SampledLogger(LogLevel log_level, SamplingPolicy policy,
+                const Context<Driver>& inherited,
+                Field<ExtraArgs>... extra)
+      : Base(inherited, extra...),
+        log_level(log_level),
+        policy(policy),
+        started(std::chrono::steady_clock::now()) {}
+
+  SampledLogger(const SampledLogger&) = delete;
+  SampledLogger& operator=(const SampledLogger&) = delete;
+
+  /**
+   * @brief Ends the request, writing or dropping the held back records.
+   */
+  ~SampledLogger() {
+    if (!kept && std::chrono::steady_clock::now() - started > policy.latency)
+      kept = true;
+    if (kept) flush();
+    clear();
+  }
+
+  /**
+   * @brief Keeps the request regardless of the policy.
+   */
+  void Keep() { kept = true; }
+
+  template <typename T>
+  void WARN(T t) { log_object(LogLevel::WARN, std::move(t)); }
+
+  template <typename... Args>
+  void WARN(std::string_view message, Field<Args>... args) {
+    log_message(LogLevel::WARN, message, std::move(args)...);
+  }
+
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void WARN(FormatString<Args...> format, const Args&... args) {
+    log_formatted(LogLevel::WARN, format.text, args...);
+  }
+
+  /**
+   * @brief Logs at FATAL level, writes the held back records and calls
+   * exit(1).
+   */
+  template <typename T>
+  void FATAL(T t) {
+    log_object(LogLevel::FATAL, std::move(t));
+    flush();
+    exit(1);
+  }
+
+  template <typename... Args>
+  void FATAL(std::string_view message, Field<Args>... args) {
+    log_message(LogLevel::FATAL, message, std::move(args)...);
+    flush();
+    exit(1);
+  }
+
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void FATAL(FormatString<Args...> format, const Args&... args) {
+    log_formatted(LogLevel::FATAL, format.text, args...);
+    flush();
+    exit(1);
+  }
+
+  template <typename T>
+  void ERROR(T t) { log_object(LogLevel::ERROR, std::move(t)); }
+
+  template <typename... Args>
+  void ERROR(std::string_view message, Field<Args>... args) {
+    log_message(LogLevel::ERROR, message, std::move(args)...);
+  }
+
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void ERROR(FormatString<Args...> format, const Args&... args) {
+    log_formatted(LogLevel::ERROR, format.text, args...);
+  }
+
+  template <typename T>
+  void INFO(T t) { log_object(LogLevel::INFO, std::move(t)); }
+
+  template <typename... Args>
+  void INFO(std::string_view message, Field<Args>... args) {
+    log_message(LogLevel::INFO, message, std::move(args)...);
+  }
+
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void INFO(FormatString<Args...> format, const Args&... args) {
+    log_formatted(LogLevel::INFO, format.text, args...);
+  }
+
+  template <typename T>
+  void DEBUG(T t) { log_object(LogLevel::DEBUG, std::move(t)); }
+
+  template <typename... Args>
+  void DEBUG(std::string_view message, Field<Args>... args) {
+    log_message(LogLevel::DEBUG, message, std::move(args)...);
+  }
+
+  template <typename... Args>
+    requires FormatArgs<Args...>
+  void DEBUG(FormatString<Args...> format, const Args&... args) {
+    log_formatted(LogLevel::DEBUG, format.text, args...);
+  }
+
+ private:
+  /**
+   * @brief A record held back, linked in logging order.
+   */
+  struct Captured {
+    Captured* next = nullptr;
+    std::uint64_t stamp;
+    LogLevel level;
+
+    Captured(LogLevel level) : stamp(clock::stamp()), level(level) {}
+    virtual ~Captured() = default;
+    virtual void emit(SampledLogger& logger) = 0;
+  };
+
+  template <typename T>
+  struct CapturedObject : Captured {
+    T object;
+
+    CapturedObject(LogLevel level, T&& object)
+        : Captured(level), object(std::move(object)) {}
+    void emit(SampledLogger& logger) override {
+      logger.print_object(object, this->level);
+    }
+  };
+
+  template <typename... Args>
+  struct CapturedMessage : Captured {
+    std::string_view message;
+    std::tuple<Field<Args>...> args;
+
+    CapturedMessage(LogLevel level, std::string_view message, Field<Args>&&... args)
+        : Captured(level), message(message), args(std::move(args)...) {}
+    void emit(SampledLogger& logger) override {
+      std::apply(
+          [&](const auto&... args) {
+            logger.print_message(message, this->level, args...);
+          },
+          args);
+    }
+  };
+
+  /**
+   * @brief A formatted message held back with copies of its values, it is
+   * formatted only if written.
+   */
+  template <typename... Args>
+  struct CapturedFormatted : Captured {
+    std::string_view format;
+    std::tuple<Args...> args;
+
+    CapturedFormatted(LogLevel level, std::string_view format, Args&&... args)
+        : Captured(level), format(format), args(std::move(args)...) {}
+    void emit(SampledLogger& logger) override {
+      std::apply(
+          [&](const auto&... args) {
+            logger.print_formatted(format, this->level, args...);
+          },
+          args);
+    }
+  };
+
+  template <typename T>
+  void log_object(LogLevel level, T&& t) {
+    if (level <= policy.trigger) kept = true;
+    if (level <= log_level)
+      Base::print_object(t, level);
+    else
+      append(arena.template make<CapturedObject<T>>(level, own(std::move(t))));
+  }
+
+  template <typename... Args>
+  void log_message(LogLevel level, std::string_view message, Field<Args>&&... args) {
+    if (level <= policy.trigger) kept = true;
+    if (level <= log_level)
+      Base::print_message(message, level, args...);
+    else
+      append(arena.template make<CapturedMessage<Args...>>(level, keep(message),
+                                                           own(std::move(args))...));
+  }
+
+  /**
+   * @brief The format text is a constant, so only the values are copied.
+   */
+  template <typename... Args>
+  void log_formatted(LogLevel level, std::string_view format, const Args&... args) {
+    if (level <= policy.trigger) kept = true;
+    if (level <= log_level)
+      Base::print_formatted(format, level, args...);
+    else
+      append(arena.template make<CapturedFormatted<std::decay_t<Args>...>>(
+          level, format, own(std::decay_t<Args>(args))...));
+  }
+
+  /**
+   * @brief Copies text into the arena, NUL terminated.
+   */
+  std::string_view keep(std::string_view text) {
+    char* copy = static_cast<char*>(arena.allocate(text.size() + 1, 1));
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return std::string_view(copy, text.size());
+  }
+
+  /**
+   * @brief Points the value of a field, a value or an object at a copy in
+   * the arena when it only refers to text held by the caller, which may be
+   * gone once the record is written: string_view, and char pointers, const
+   * or not, which arrays decay to.
+   */
+  template <typename T>
+  Field<T>&& own(Field<T>&& field) {
+    field.value = own(std::move(field.value));
+    return std::move(field);
+  }
+
+  template <typename T>
+  T&& own(T&& value) {
+    using V = std::decay_t<T>;
+    if constexpr (std::is_same<V, std::string_view>::value) {
+      value = keep(value);
+    } else if constexpr (std::is_same<V, const char*>::value ||
+                         std::is_same<V, char*>::value) {
+      if (value) value = const_cast<V>(keep(value).data());
+    }
+    return std::move(value);
+  }
+
+  void append(Captured* record) {
+    if (tail)
+      tail->next = record;
+    else
+      head = record;
+    tail = record;
+  }
+
+  /**
+   * @brief Writes the held back records, each with the time it was logged.
+   */
+  void flush() {
+    for (Captured* record = head; record; record = record->next) {
+      clock::replay_stamp = record->stamp;
+      record->emit(*this);
+    }
+    clock::replay_stamp = 0;
+    clear();
+  }
+
+  void clear() {
+    for (Captured* record = head; record;) {
+      Captured* next = record->next;
+      record->~Captured();
+      record = next;
+    }
+    head = tail = nullptr;
+    arena.release();
+  }
+
+  LogLevel log_level;
+  SamplingPolicy policy;
+  std::chrono::steady_clock::time_point started;
+  bool kept = false;
+  Arena arena;
+  Captured* head = nullptr;
+  Captured* tail = nullptr;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SAMPLED_HPP
@@ -0,0 +1,68 @@
+#ifndef PTCLOGS_SINK_ASYNC_BUFFER_HPP
+#define PTCLOGS_SINK_ASYNC_BUFFER_HPP
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "ptclogs/driver/json_driver.hpp"
+#include "ptclogs/sink/overflow.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Queues records and writes them to a file descriptor from a
+ * background thread, so logging threads never wait on the descriptor unless
+ * the policy says so.
+ *
+ * When the queue drains after records were dropped, a synthetic record with
+ * the per level drop counts is written.
+ */
+class AsyncBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer and starts its writer thread.
+   *
+   * @param fd File descriptor records are written to.
+   * @param policy What to do when the queue is full.
+   * @param reporter Renders the synthetic drop report.
+   */
+  AsyncBuffer(int fd, OverflowPolicy policy = OverflowPolicy(),
+              DropReporter reporter = drop_reporter<JSONDriver>());
+
+  /**
+   * @brief Writes out every queued record and stops the writer thread.
+   */
+  ~AsyncBuffer();
+
+  /**
+   * @brief Returns the number of bytes waiting in the queue.
+   */
+  std::size_t pending();
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+  void commit_batch(const char* data, const BatchRecord* records, std::size_t count) override;
+
+ private:
+  /**
+   * @brief Queues a record, waiting or dropping as the policy says.
+   *
+   * @return Whether the record was queued.
+   */
+  bool enqueue(std::unique_lock<std::mutex>& lock, LogLevel level, const char* data,
+               std::size_t size);
+  void run();
+  void write_all(const char* data, std::size_t size);
+
+  int fd;
+  RecordQueue queue;
+  DropReporter reporter;
+  std::mutex mutex;
+  std::condition_variable has_records;
+  std::condition_variable has_room;
+  bool done = false;
+  std::thread writer;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_ASYNC_BUFFER_HPP
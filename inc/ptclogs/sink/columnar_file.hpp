@@ -0,0 +1,69 @@
+#ifndef PTCLOGS_SINK_COLUMNAR_FILE_HPP
+#define PTCLOGS_SINK_COLUMNAR_FILE_HPP
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ptclogs/columnar.hpp"
+#include "ptclogs/reader.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Writes JSONDriver records to a columnar segment file, see
+ * ptclogs/columnar.hpp.
+ *
+ * Records are grouped by shape, the keys they have in order, and a shape's
+ * records are written as a block once block_records of them are buffered,
+ * or by a background thread once the oldest of them waited flush_interval.
+ * The file holds whole blocks only and a crash loses what was buffered.
+ * Records keep their ts field and are also stamped with the time they were
+ * committed, in nanoseconds. Lines that aren't JSON objects are kept
+ * verbatim.
+ *
+ * Blocks of different shapes are written as they fill, so the file is only
+ * ordered by time within a block; ptclogs-columns merges the blocks by
+ * commit time when printing.
+ */
+class ColumnarFileBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer appending blocks to the segment at path and
+   * starts its flush thread, unless the flush interval is zero.
+   *
+   * @param path Segment file, created if missing.
+   * @param options Block size, shape and dictionary limits.
+   */
+  ColumnarFileBuffer(const std::string& path, columnar::SegmentOptions options = {});
+
+  /**
+   * @brief Stops the flush thread, writes every buffered block and closes
+   * the file.
+   */
+  ~ColumnarFileBuffer();
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+
+ private:
+  void write_all();
+  void write_block(columnar::BlockBuilder& block);
+  void run();
+
+  int fd;
+  columnar::SegmentOptions options;
+  std::unordered_map<std::string, columnar::BlockBuilder> shapes;
+  std::string shape;
+  std::vector<reader::Field> fields;
+  std::string encoded;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool done = false;
+  std::thread flusher;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_COLUMNAR_FILE_HPP
@@ -0,0 +1,58 @@
+#ifndef PTCLOGS_SINK_FD_BUFFER_HPP
+#define PTCLOGS_SINK_FD_BUFFER_HPP
+#include <mutex>
+
+#include "ptclogs/driver/json_driver.hpp"
+#include "ptclogs/sink/overflow.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Writes records straight to a file descriptor in non-blocking mode.
+ *
+ * Whatever the descriptor does not accept right away is kept in an overflow
+ * buffer bounded by the policy and written out on later records. When the
+ * overflow buffer drains after records were dropped, a synthetic record with
+ * the per level drop counts is written. A record the descriptor fails to
+ * take with an error other than EAGAIN is counted as dropped too.
+ *
+ * Note that O_NONBLOCK is set on the open file description, so other writers
+ * sharing it (e.g. std::cout on STDOUT_FILENO) see it too.
+ */
+class FdBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer writing to fd.
+   *
+   * @param fd File descriptor records are written to, e.g. STDOUT_FILENO.
+   * @param policy What to do when the overflow buffer is full.
+   * @param reporter Renders the synthetic drop report.
+   */
+  FdBuffer(int fd, OverflowPolicy policy = OverflowPolicy(),
+           DropReporter reporter = drop_reporter<JSONDriver>());
+
+  /**
+   * @brief Blocks until the overflow buffer is written out.
+   */
+  ~FdBuffer();
+
+  /**
+   * @brief Returns the number of bytes waiting in the overflow buffer.
+   */
+  std::size_t pending();
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+
+ private:
+  bool drain();
+  bool wait_writable(int timeout_ms);
+
+  int fd;
+  RecordQueue queue;
+  DropReporter reporter;
+  std::mutex mutex;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_FD_BUFFER_HPP
@@ -0,0 +1,57 @@
+#ifndef PTCLOGS_SINK_INDEXED_FILE_HPP
+#define PTCLOGS_SINK_INDEXED_FILE_HPP
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ptclogs/index.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Appends records to a file and writes a sidecar index of it to
+ * <path>.idx, see ptclogs/index.hpp.
+ *
+ * Indexing a record takes a clock read, a level bit and a scan of the record
+ * for each indexed key, so the indexed keys are best kept few. Blocks are
+ * indexed by the time records were committed, which is within the write
+ * latency of their ts field, or by the time replayed records were logged.
+ *
+ * The index of an existing file is appended to with the options it was
+ * created with, which take precedence over those given. If it is missing or
+ * can't be read, a new index is started and the records already in the file
+ * are left unindexed.
+ */
+class IndexedFileBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer appending to the file at path.
+   *
+   * @param path Log file, created if missing.
+   * @param options Block size, bloom filter size and indexed keys.
+   */
+  IndexedFileBuffer(const std::string& path, index::IndexOptions options = {});
+
+  /**
+   * @brief Indexes the last block and closes the files.
+   */
+  ~IndexedFileBuffer();
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+
+ private:
+  void close_block();
+
+  int fd;
+  int index_fd;
+  index::IndexOptions options;
+  std::uint64_t offset;
+  index::IndexBlock block{};
+  std::vector<std::uint64_t> bloom;
+  std::mutex mutex;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_INDEXED_FILE_HPP
@@ -0,0 +1,171 @@
+#ifndef PTCLOGS_SINK_OVERFLOW_HPP
+#define PTCLOGS_SINK_OVERFLOW_HPP
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/memory.hpp"
+
+namespace logger {
+
+/**
+ * @brief What a buffered sink does with a record that does not fit.
+ */
+enum class OverflowMode {
+  BLOCK,          ///< Wait until there is room.
+  BLOCK_TIMEOUT,  ///< Wait up to the policy timeout, then drop the record.
+  DROP_NEWEST,    ///< Drop the incoming record.
+  DROP_OLDEST,    ///< Evict the oldest pending records to make room.
+  SHED_BY_LEVEL,  ///< Shed DEBUG, then INFO, then WARN. ERROR and FATAL wait.
+};
+
+/**
+ * @brief Overload behaviour of a buffered sink.
+ */
+struct OverflowPolicy {
+  OverflowMode mode = OverflowMode::BLOCK;
+
+  /**
+   * @brief Maximum number of pending bytes.
+   */
+  std::size_t capacity = 1 << 20;
+
+  /**
+   * @brief How long BLOCK_TIMEOUT waits before dropping.
+   */
+  std::chrono::milliseconds timeout{10};
+
+  /**
+   * @brief Fill ratios above which SHED_BY_LEVEL refuses new DEBUG and INFO
+   * records, even before the buffer is full.
+   */
+  double shed_debug_at = 0.5;
+  double shed_info_at = 0.75;
+};
+
+/**
+ * @brief Number of dropped records, indexed by LogLevel.
+ */
+using DropCounts = std::array<std::uint64_t, 5>;
+
+/**
+ * @brief Renders the synthetic record that reports dropped records.
+ */
+using DropReporter = std::function<std::string(const DropCounts&)>;
+
+/**
+ * @brief Bounded queue of pending records that applies an OverflowPolicy.
+ *
+ * The queue does no locking or waiting by itself; owners decide how to wait
+ * when admit returns WAIT.
+ */
+class RecordQueue {
+ public:
+  enum Admission { ADMIT, DROP, WAIT };
+
+  struct Record {
+    LogLevel level;
+    std::pmr::string data;
+  };
+
+  /**
+   * @brief Queued records are allocated from memory::resource as it is when
+   * the queue is created.
+   */
+  RecordQueue(OverflowPolicy policy) : policy(policy), records(memory::resource()){};
+
+  /**
+   * @brief Decides whether a record can be queued, evicting pending records
+   * if the policy allows it.
+   *
+   * @param level Level of the incoming record.
+   * @param size Size of the incoming record in bytes.
+   * @param expired Whether the caller has already waited as long as allowed.
+   */
+  Admission admit(LogLevel level, std::size_t size, bool expired = false);
+
+  /**
+   * @brief Queues a record. Must only be called after admit returned ADMIT.
+   */
+  void push(LogLevel level, const char* data, std::size_t size);
+
+  /**
+   * @brief Counts a record as dropped.
+   */
+  void drop(LogLevel level);
+
+  /**
+   * @brief Marks the first n bytes of the oldest record as written.
+   */
+  void consume(std::size_t n);
+
+  /**
+   * @brief Removes the oldest record.
+   */
+  void pop();
+
+  /**
+   * @brief Moves all pending records into out.
+   */
+  void take(std::pmr::deque<Record>& out);
+
+  const Record& front() const { return records.front(); }
+  bool empty() const { return records.empty(); }
+  std::size_t size() const { return bytes; }
+  const OverflowPolicy& get_policy() const { return policy; }
+
+  /**
+   * @brief Returns and clears the drop counts accumulated since the last call.
+   *
+   * @return Whether any record was dropped.
+   */
+  bool take_drops(DropCounts& counts);
+
+ private:
+  bool fits(std::size_t size) const;
+  bool evict_above(int level);
+
+  OverflowPolicy policy;
+  std::pmr::deque<Record> records;
+  std::size_t bytes = 0;
+  DropCounts dropped{};
+};
+
+/**
+ * @brief Builds a DropReporter that renders the drop report with Driver.
+ *
+ * @tparam Driver Driver used to format the synthetic record.
+ */
+template <class Driver>
+DropReporter drop_reporter() {
+  return [](const DropCounts& counts) {
+    static const char* names[] = {"dropped_fatal", "dropped_error",
+                                  "dropped_warn", "dropped_info",
+                                  "dropped_debug"};
+    std::ostringstream ss;
+    Driver driver(ss);
+    driver.begin_message();
+    driver.print_timestamp();
+    driver.separator();
+    driver.print_level(LogLevel::WARN);
+    driver.separator();
+    driver.print_message("log records dropped under backpressure");
+    for (int i = 0; i < 5; i++) {
+      driver.separator();
+      driver.print_field(names[i], counts[i]);
+    }
+    driver.end_message();
+    ss << '\n';
+    return ss.str();
+  };
+}
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_OVERFLOW_HPP
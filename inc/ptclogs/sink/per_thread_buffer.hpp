@@ -0,0 +1,69 @@
+#ifndef PTCLOGS_SINK_PER_THREAD_BUFFER_HPP
+#define PTCLOGS_SINK_PER_THREAD_BUFFER_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Gives every logging thread its own lock-free ring and merges the
+ * rings on a collector thread, so threads never contend on the output.
+ *
+ * Records are stamped with a monotonic nanosecond clock when committed. The
+ * collector k-way merges the rings by that stamp and writes out every record
+ * older than the reordering window, so the output is globally time ordered as
+ * long as no thread lags behind by more than the window.
+ */
+class PerThreadBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer and starts its collector thread.
+   *
+   * @param fd File descriptor records are written to.
+   * @param window Reordering window: how long records are held back waiting
+   * for older records from other threads.
+   * @param ring_size Bytes of each thread ring, rounded up to a power of two.
+   */
+  PerThreadBuffer(int fd,
+                  std::chrono::microseconds window = std::chrono::milliseconds(2),
+                  std::size_t ring_size = 1 << 20);
+
+  /**
+   * @brief Writes out every pending record and stops the collector.
+   */
+  ~PerThreadBuffer();
+
+  struct Ring;
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+
+ private:
+  Ring& local();
+  void run();
+  bool collect(std::uint64_t horizon);
+  void write_all(const char* data, std::size_t size);
+
+  int fd;
+  std::chrono::microseconds window;
+  std::size_t ring_size;
+  std::uint64_t id;
+  std::mutex rings_mutex;
+  std::vector<std::shared_ptr<Ring>> rings;
+  std::atomic<bool> pressure{false};
+  std::mutex write_mutex;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool done = false;
+  std::thread collector;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_PER_THREAD_BUFFER_HPP
@@ -0,0 +1,97 @@
+#ifndef PTCLOGS_SINK_RECORD_BUFFER_HPP
+#define PTCLOGS_SINK_RECORD_BUFFER_HPP
+#include <cstddef>
+#include <streambuf>
+
+#include "ptclogs/driver/idriver.hpp"
+
+namespace logger {
+
+/**
+ * @brief Level of the record currently being written by this thread.
+ *
+ * Loggers set it before printing a record so that record oriented buffers can
+ * make level aware decisions without parsing the formatted output.
+ */
+inline thread_local LogLevel record_level = LogLevel::INFO;
+
+/**
+ * @brief Marks the beginning of a record at the given level on this thread.
+ *
+ * @param level Level of the record that will be written.
+ */
+inline void set_record_level(LogLevel level) { record_level = level; }
+
+/**
+ * @brief A record of a batch: its level and the offset right after its last
+ * byte.
+ */
+struct BatchRecord {
+  LogLevel level;
+  std::size_t end;
+};
+
+/**
+ * @brief Records of the batch this thread is flushing, empty otherwise.
+ *
+ * Batches write many records and flush once; the layout lets record oriented
+ * buffers still hand each record over on its own.
+ */
+inline thread_local const BatchRecord* batch_records = nullptr;
+inline thread_local std::size_t batch_size = 0;
+
+/**
+ * @brief Sets the layout of the batch about to be flushed on this thread.
+ * Pass nullptr and 0 once it is flushed.
+ */
+inline void set_record_batch(const BatchRecord* records, std::size_t count) {
+  batch_records = records;
+  batch_size = count;
+}
+
+/**
+ * @brief Stream buffer that collects whole records and hands them over to
+ * commit once the stream is flushed.
+ *
+ * Loggers flush their stream after every record, so each commit receives
+ * exactly one complete line. Batches flush once for all their records, which
+ * reach commit_batch together. Bytes are staged per thread and buffer, which
+ * keeps records written concurrently from different threads, or logged to
+ * another buffer while one is being formatted, from interleaving.
+ *
+ * Usage:
+ *   SomeBuffer buf(...);
+ *   std::ostream stream(&buf);
+ *   Logger<JSONDriver, stream> logger;
+ */
+class RecordBuffer : public std::streambuf {
+ public:
+  virtual ~RecordBuffer() = default;
+
+ protected:
+  /**
+   * @brief Receives a complete record.
+   *
+   * @param level Level of the record.
+   * @param data Formatted bytes of the record, including the line terminator.
+   * @param size Number of bytes in data.
+   */
+  virtual void commit(LogLevel level, const char* data, std::size_t size) = 0;
+
+  /**
+   * @brief Receives the records of a batch, laid out back to back in data.
+   * By default each one is committed on its own; buffers that can take them
+   * at once, under one lock or in one write, override it.
+   *
+   * @param records Level and end offset of each record.
+   * @param count Number of records.
+   */
+  virtual void commit_batch(const char* data, const BatchRecord* records, std::size_t count);
+
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_RECORD_BUFFER_HPP
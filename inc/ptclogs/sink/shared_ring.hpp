@@ -0,0 +1,106 @@
+#ifndef PTCLOGS_SINK_SHARED_RING_HPP
+#define PTCLOGS_SINK_SHARED_RING_HPP
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ptclogs/driver/json_driver.hpp"
+#include "ptclogs/sink/overflow.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+/**
+ * @brief Record buffer in shared memory, written by several processes and
+ * drained by one of them.
+ *
+ * The shared segment holds a number of lanes, single producer rings that
+ * writing threads claim for themselves, so processes append records without
+ * locks and without contending on each other. A record becomes visible only
+ * once it is complete, so a process dying mid-record never leaves a partial
+ * line: the drainer notices the owner is gone, writes out what it published
+ * and frees the lane. Owners are told apart by pid and process start time,
+ * so a recycled pid doesn't keep a lane claimed.
+ *
+ * The process calling drain_to k-way merges the lanes by commit time, like
+ * PerThreadBuffer, and writes everything older than the reordering window.
+ *
+ * Usage in a pre-fork server:
+ *   SharedRingBuffer ring;  // created before forking, inherited by workers
+ *   std::ostream stream(&ring);
+ *   ring.drain_to(STDOUT_FILENO);  // in the parent
+ *   fork() ...  // workers log through Logger<JSONDriver, stream>
+ */
+class SharedRingBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Creates an anonymous ring, inherited by the children forked after.
+   *
+   * @param lanes Number of lanes, at least the number of threads logging at
+   * the same time across all processes.
+   * @param lane_size Bytes of each lane, rounded up to a power of two. Records
+   * larger than half a lane are dropped, and reported by the drainer.
+   * @param reporter Renders the synthetic drop report, in the draining
+   * process.
+   */
+  SharedRingBuffer(std::size_t lanes = 64, std::size_t lane_size = 1 << 18,
+                   DropReporter reporter = drop_reporter<JSONDriver>());
+
+  /**
+   * @brief Creates the ring shm_open(name) or attaches to it if it exists, so
+   * unrelated processes can share it. The lane settings of the creator win.
+   *
+   * @param name Name of the shared memory object, e.g. "/myserver-log".
+   */
+  SharedRingBuffer(const std::string& name, std::size_t lanes = 64,
+                   std::size_t lane_size = 1 << 18,
+                   DropReporter reporter = drop_reporter<JSONDriver>());
+
+  /**
+   * @brief Stops draining, writing out every published record first, and
+   * unmaps the ring. The creator of a named ring unlinks it.
+   */
+  ~SharedRingBuffer();
+
+  /**
+   * @brief Returns whether the shared segment could be set up.
+   */
+  bool valid() const { return control != nullptr; }
+
+  /**
+   * @brief Drains the ring to fd from a thread of the calling process. Only
+   * one process may drain a ring.
+   *
+   * @param fd File descriptor records are written to.
+   * @param window Reordering window across lanes.
+   */
+  void drain_to(int fd, std::chrono::microseconds window = std::chrono::milliseconds(2));
+
+  struct Control;
+  struct Lane;
+  struct Drainer;
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+
+ private:
+  void map(int shm, std::size_t size, bool init, std::size_t lanes, std::size_t lane_size);
+  std::size_t local();
+  Lane* lanes();
+  char* lane_data(std::size_t index);
+  void run();
+  bool collect(int fd, std::uint64_t horizon);
+
+  Control* control = nullptr;
+  std::size_t mapped = 0;
+  std::string name;
+  bool creator = false;
+  std::uint64_t id;
+  DropReporter reporter;
+
+  std::unique_ptr<Drainer> drainer;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_SHARED_RING_HPP
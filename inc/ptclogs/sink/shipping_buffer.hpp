@@ -0,0 +1,138 @@
+#ifndef PTCLOGS_SINK_SHIPPING_BUFFER_HPP
+#define PTCLOGS_SINK_SHIPPING_BUFFER_HPP
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ptclogs/driver/json_driver.hpp"
+#include "ptclogs/sink/overflow.hpp"
+#include "ptclogs/sink/record_buffer.hpp"
+
+namespace logger {
+struct ShippingOptions {
+  /**
+   * @brief Maximum payload of a frame. Larger records get a frame of their
+   * own.
+   */
+  std::size_t frame_bytes = 1 << 16;
+  /**
+   * @brief Wait before the first reconnection attempt, doubled after every
+   * failed one up to max_backoff.
+   */
+  std::chrono::milliseconds min_backoff{100};
+  std::chrono::milliseconds max_backoff{10000};
+  /**
+   * @brief How long connecting or sending may block before the collector is
+   * taken as down.
+   */
+  std::chrono::milliseconds timeout{2000};
+  /**
+   * @brief File frames are spooled to while the collector is down. Empty
+   * keeps them in the queue instead, under its overflow policy.
+   */
+  std::string spool;
+  /**
+   * @brief Maximum size of the spool file. Frames that don't fit are dropped
+   * and reported.
+   */
+  std::uint64_t spool_bytes = std::uint64_t(1) << 28;
+};
+
+/**
+ * @brief Ships records to a collector listening on a unix or TCP socket,
+ * from a background thread.
+ *
+ * Records are sent in frames: a 4 byte big endian length followed by that
+ * many bytes of whole records, each ending with a newline. Whatever queued
+ * up while the thread was busy goes out together, with one sendmsg for
+ * several frames.
+ *
+ * While the collector is unreachable the buffer reconnects with exponential
+ * backoff and appends frames to a bounded spool file, in the same format.
+ * Once connected again the spool is replayed, in order, before any newer
+ * record. Without a spool, frames are held back until the collector is back,
+ * and the queue fills up behind them.
+ *
+ * A send that fails partway only resends the frames that didn't go out
+ * whole, so a live process sends each frame once. A spool left by a previous
+ * run is replayed too, so frames spooled right before a crash may be sent
+ * twice: delivery is at least once across restarts. Records written to the
+ * socket before the collector went down without reading them are lost.
+ *
+ * Usage:
+ *   ShippingBuffer buffer("unix:/run/collector.sock",
+ *                         ShippingOptions{.spool = "/var/spool/app/logs"});
+ *   std::ostream stream(&buffer);
+ *   Logger<JSONDriver, stream> logger;
+ */
+class ShippingBuffer : public RecordBuffer {
+ public:
+  /**
+   * @brief Instantiates a buffer and starts its sender thread, which
+   * connects in the background.
+   *
+   * @param address "unix:PATH" or "tcp:HOST:PORT".
+   * @param options Framing, reconnection and spool settings.
+   * @param policy What to do when the queue is full.
+   * @param reporter Renders the synthetic drop report.
+   */
+  ShippingBuffer(const std::string& address, ShippingOptions options = ShippingOptions(),
+                 OverflowPolicy policy = OverflowPolicy(),
+                 DropReporter reporter = drop_reporter<JSONDriver>());
+
+  /**
+   * @brief Sends every queued record, or spools it if the collector is down,
+   * and stops the sender thread. Without a spool, what can't be sent is
+   * counted as dropped in the telemetry.
+   */
+  ~ShippingBuffer();
+
+  /**
+   * @brief Returns the number of bytes waiting in the queue.
+   */
+  std::size_t pending();
+
+  /**
+   * @brief Returns the number of bytes waiting in the spool.
+   */
+  std::uint64_t spooled();
+
+  /**
+   * @brief Returns whether the collector is connected.
+   */
+  bool connected();
+
+ protected:
+  void commit(LogLevel level, const char* data, std::size_t size) override;
+  void commit_batch(const char* data, const BatchRecord* records, std::size_t count) override;
+
+ private:
+  struct Sender;
+
+  /**
+   * @brief Queues a record, waiting or dropping as the policy says.
+   *
+   * @return Whether the record was queued.
+   */
+  bool enqueue(std::unique_lock<std::mutex>& lock, LogLevel level, const char* data,
+               std::size_t size);
+  void run();
+
+  std::string address;
+  ShippingOptions options;
+  RecordQueue queue;
+  DropReporter reporter;
+  std::mutex mutex;
+  std::condition_variable has_records;
+  std::condition_variable has_room;
+  bool done = false;
+  bool is_connected = false;
+  std::uint64_t spool_size = 0;
+  std::thread sender;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_SINK_SHIPPING_BUFFER_HPP
@@ -0,0 +1,239 @@
+#ifndef PTCLOGS_TELEMETRY_HPP
+#define PTCLOGS_TELEMETRY_HPP
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/value.hpp"
+
+/**
+ * Self telemetry of the library: records and bytes per level, drops, flushes,
+ * the queue high-water mark and a histogram of the time spent inside logging
+ * calls.
+ *
+ * Counters are kept per thread and only ever written by their own thread, so
+ * recording is wait-free. snapshot aggregates them on demand.
+ *
+ * Everything compiles to nothing unless PTCLOGS_TELEMETRY is defined, both
+ * for the library (make TELEMETRY=1) and for the code including it.
+ */
+namespace logger::telemetry {
+
+/**
+ * @brief Number of buckets of a latency histogram. Buckets are log-linear
+ * with 8 sub-buckets per power of two, which keeps every bucket within 12.5%
+ * of its value, up to about an hour.
+ */
+constexpr std::size_t histogram_buckets = 320;
+
+/**
+ * @brief Returns the bucket a duration in nanoseconds falls in.
+ */
+constexpr std::size_t bucket(std::uint64_t ns) {
+  if (ns < 8) return ns;
+  int msb = 63 - __builtin_clzll(ns);
+  int shift = msb - 3;
+  std::size_t index = (shift + 1) * 8 + ((ns >> shift) & 7);
+  return index < histogram_buckets ? index : histogram_buckets - 1;
+}
+
+/**
+ * @brief Returns the largest duration in nanoseconds that falls in a bucket.
+ */
+constexpr std::uint64_t bucket_limit(std::size_t index) {
+  if (index < 8) return index;
+  int shift = index / 8 - 1;
+  return ((8 + index % 8 + std::uint64_t(1)) << shift) - 1;
+}
+
+/**
+ * @brief Counters of one thread. Only the owning thread writes them.
+ */
+struct Counters {
+  std::atomic<std::uint64_t> records[5]{};
+  std::atomic<std::uint64_t> bytes[5]{};
+  std::atomic<std::uint64_t> drops[5]{};
+  std::atomic<std::uint64_t> flushes{};
+  std::atomic<std::uint64_t> queue_high_water{};
+  std::atomic<std::uint64_t> latency[5][histogram_buckets]{};
+  std::atomic<std::uint64_t> latency_ns[5]{};
+};
+
+/**
+ * @brief Adds n to a counter owned by the calling thread.
+ */
+inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t n) {
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+/**
+ * @brief Aggregated latency histogram of one level.
+ */
+struct Histogram {
+  std::array<std::uint64_t, histogram_buckets> counts{};
+
+  /**
+   * @brief Returns the number of recorded calls.
+   */
+  std::uint64_t count() const;
+
+  /**
+   * @brief Returns an upper bound, in nanoseconds, of the given percentile.
+   *
+   * @param p Percentile between 0 and 100.
+   */
+  std::uint64_t percentile(double p) const;
+};
+
+/**
+ * @brief The hooks, and everything reading the counters, live in a namespace
+ * named after PTCLOGS_TELEMETRY. Code built with and without it never shares
+ * a definition, and a program mixing the library of one setting with code
+ * of the other fails to link instead of silently losing its counters.
+ */
+#ifdef PTCLOGS_TELEMETRY
+#define PTCLOGS_TELEMETRY_ABI enabled
+#else
+#define PTCLOGS_TELEMETRY_ABI disabled
+#endif
+inline namespace PTCLOGS_TELEMETRY_ABI {
+#ifdef PTCLOGS_TELEMETRY
+/**
+ * @brief Returns the counters of the calling thread, registering them on
+ * first use.
+ */
+Counters& local();
+
+struct Stamp {
+  std::chrono::steady_clock::time_point at;
+};
+inline Stamp start() { return Stamp{std::chrono::steady_clock::now()}; }
+inline void record(LogLevel level, Stamp stamp) {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - stamp.at)
+                .count();
+  Counters& c = local();
+  add(c.records[level], 1);
+  add(c.latency[level][bucket(ns)], 1);
+  add(c.latency_ns[level], ns);
+}
+inline void bytes(LogLevel level, std::size_t n) { add(local().bytes[level], n); }
+inline void drop(LogLevel level) { add(local().drops[level], 1); }
+inline void flush() { add(local().flushes, 1); }
+inline void queue_depth(std::size_t depth) {
+  auto& hwm = local().queue_high_water;
+  if (depth > hwm.load(std::memory_order_relaxed))
+    hwm.store(depth, std::memory_order_relaxed);
+}
+#else
+struct Stamp {};
+inline Stamp start() { return Stamp{}; }
+inline void record(LogLevel, Stamp) {}
+inline void bytes(LogLevel, std::size_t) {}
+inline void drop(LogLevel) {}
+inline void flush() {}
+inline void queue_depth(std::size_t) {}
+#endif
+
+/**
+ * @brief Counters of every thread, summed up.
+ */
+struct Snapshot {
+  std::array<std::uint64_t, 5> records{};
+  std::array<std::uint64_t, 5> bytes{};
+  std::array<std::uint64_t, 5> drops{};
+  std::uint64_t flushes = 0;
+  std::uint64_t queue_high_water = 0;
+  std::array<Histogram, 5> latency{};
+  /**
+   * @brief Exact total of the time spent inside logging calls, in
+   * nanoseconds.
+   */
+  std::array<std::uint64_t, 5> latency_ns{};
+};
+
+/**
+ * @brief Aggregates the counters of all live and finished threads.
+ */
+Snapshot snapshot();
+
+/**
+ * @brief Renders a snapshot in the Prometheus text exposition format. The
+ * call latency is exported in 13 buckets per level, bounded by powers of 4
+ * from 2^10ns (about 1us) to 2^34ns (about 17s), with its exact sum.
+ */
+std::string to_prometheus(const Snapshot& snapshot);
+
+/**
+ * @brief Periodically hands a snapshot to a callback from a background thread.
+ *
+ * Usage:
+ *   telemetry::Reporter prom("/var/lib/node_exporter/ptclogs.prom", 10s);
+ *   telemetry::Reporter rec([&](const telemetry::Snapshot& s) {
+ *     logger.INFO("ptclogs telemetry", Field("stats", s));
+ *   }, 60s);
+ */
+class Reporter {
+ public:
+  /**
+   * @brief Reports to callback every period.
+   */
+  Reporter(std::function<void(const Snapshot&)> callback,
+           std::chrono::milliseconds period);
+
+  /**
+   * @brief Atomically rewrites a Prometheus text file at path every period.
+   */
+  Reporter(std::string path, std::chrono::milliseconds period);
+
+  /**
+   * @brief Reports one last time and stops the background thread.
+   */
+  ~Reporter();
+
+ private:
+  void run();
+
+  std::function<void(const Snapshot&)> callback;
+  std::chrono::milliseconds period;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool done = false;
+  std::thread thread;
+};
+};  // namespace PTCLOGS_TELEMETRY_ABI
+};  // namespace logger::telemetry
+
+/**
+ * @brief Logs a snapshot as an object with the per level counters and the
+ * p50/p99 call latency in nanoseconds.
+ */
+template <>
+struct logger::serializer<logger::telemetry::Snapshot> {
+  template <class Writer>
+  static void write(Writer& w, const telemetry::Snapshot& s) {
+    std::array<std::uint64_t, 5> p50, p99;
+    for (int i = 0; i < 5; i++) {
+      p50[i] = s.latency[i].percentile(50);
+      p99[i] = s.latency[i].percentile(99);
+    }
+    w.field("records", s.records);
+    w.field("bytes", s.bytes);
+    w.field("drops", s.drops);
+    w.field("flushes", s.flushes);
+    w.field("queue_high_water", s.queue_high_water);
+    w.field("latency_p50_ns", p50);
+    w.field("latency_p99_ns", p99);
+  }
+};
+
+#endif  // PTCLOGS_TELEMETRY_HPP
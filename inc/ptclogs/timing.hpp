@@ -0,0 +1,253 @@
+#ifndef PTCLOGS_TIMING_HPP
+#define PTCLOGS_TIMING_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/telemetry.hpp"
+
+namespace logger {
+/**
+ * @brief Logs a record with the time its scope took when it ends.
+ *
+ * The record carries the fields given when the timer was started followed by
+ * duration_ns. Loggers hand them out with Time.
+ *
+ * Usage:
+ *   {
+ *     auto timer = logger.Time("query done", Field("table", table));
+ *     ...
+ *   }  // {"msg":"query done","table":"users","duration_ns":48213}
+ *
+ * @tparam L Logger the record is written to.
+ * @tparam Args Types of the fields of the record.
+ */
+template <typename L, typename... Args>
+class ScopedTimer {
+ public:
+  ScopedTimer(L& logger, LogLevel level, std::string message, Field<Args>... fields)
+      : logger(logger),
+        level(level),
+        message(std::move(message)),
+        fields(std::move(fields)...),
+        started(std::chrono::steady_clock::now()) {}
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  ~ScopedTimer() { Stop(); }
+
+  /**
+   * @brief Logs the record now instead of at the end of the scope. Later
+   * calls do nothing.
+   */
+  void Stop() {
+    if (stopped) return;
+    stopped = true;
+    std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - started)
+                          .count();
+    std::apply(
+        [&](const auto&... fields) {
+          Field<std::int64_t> duration("duration_ns", ns);
+          switch (level) {
+            case LogLevel::FATAL:
+              logger.FATAL(message, fields..., duration);
+              break;
+            case LogLevel::ERROR:
+              logger.ERROR(message, fields..., duration);
+              break;
+            case LogLevel::WARN:
+              logger.WARN(message, fields..., duration);
+              break;
+            case LogLevel::INFO:
+              logger.INFO(message, fields..., duration);
+              break;
+            case LogLevel::DEBUG:
+              logger.DEBUG(message, fields..., duration);
+              break;
+          }
+        },
+        fields);
+  }
+
+  /**
+   * @brief Drops the record.
+   */
+  void Cancel() { stopped = true; }
+
+ private:
+  L& logger;
+  LogLevel level;
+  std::string message;
+  std::tuple<Field<Args>...> fields;
+  std::chrono::steady_clock::time_point started;
+  bool stopped = false;
+};
+
+class LatencySeries;
+
+/**
+ * @brief Latency histograms aggregated in the library and logged as one
+ * summary record per series and period, instead of a record per event.
+ *
+ * Every thread records into histograms of its own, with the buckets of
+ * telemetry::Histogram, so recording is wait-free and never contends. A
+ * background thread adds them up every period and logs the events of the
+ * period: count, p50, p90, p99 and max in nanoseconds, as bucket upper
+ * bounds within 12.5%.
+ *
+ * Usage:
+ *   LatencySummary latency(logger, std::chrono::seconds(10));
+ *   LatencySeries query = latency.series("db.query");
+ *   {
+ *     auto sample = query.time();
+ *     ...
+ *   }
+ *   // every 10s: {"msg":"latency summary","series":"db.query","count":91234,
+ *   //             "p50_ns":40959,"p90_ns":90111,"p99_ns":262143,"max_ns":1048575}
+ */
+class LatencySummary {
+ public:
+  /**
+   * @brief Receives the histogram of a series over the last period.
+   */
+  using Emit = std::function<void(const std::string& series, const telemetry::Histogram& period)>;
+
+  /**
+   * @brief Hands the histogram of each series with events to emit every
+   * period.
+   */
+  LatencySummary(Emit emit, std::chrono::milliseconds period);
+
+  /**
+   * @brief Logs a summary record per series through logger every period.
+   * The logger must outlive the summary.
+   */
+  template <typename L>
+  LatencySummary(L& logger, std::chrono::milliseconds period)
+      : LatencySummary(
+            [&logger](const std::string& series, const telemetry::Histogram& h) {
+              std::uint64_t max = 0;
+              for (std::size_t b = 0; b < telemetry::histogram_buckets; b++)
+                if (h.counts[b]) max = telemetry::bucket_limit(b);
+              logger.INFO("latency summary", Field<std::string_view>("series", series),
+                          Field<std::uint64_t>("count", h.count()),
+                          Field<std::uint64_t>("p50_ns", h.percentile(50)),
+                          Field<std::uint64_t>("p90_ns", h.percentile(90)),
+                          Field<std::uint64_t>("p99_ns", h.percentile(99)),
+                          Field<std::uint64_t>("max_ns", max));
+            },
+            period) {}
+
+  /**
+   * @brief Emits the events since the last period and stops the background
+   * thread.
+   */
+  ~LatencySummary();
+
+  /**
+   * @brief Most series of a summary. Events of series past it are ignored.
+   */
+  static constexpr std::size_t max_series = 1024;
+
+  /**
+   * @brief Returns the handle of the series called name, adding it on first
+   * use.
+   */
+  LatencySeries series(const std::string& name);
+
+  /**
+   * @brief Records an event of a series.
+   *
+   * @param series Index of the series.
+   * @param ns Duration of the event in nanoseconds.
+   */
+  void record(std::size_t series, std::uint64_t ns) {
+    if (std::atomic<std::uint64_t>* counts = local(series))
+      telemetry::add(counts[telemetry::bucket(ns)], 1);
+  }
+
+  /**
+   * @brief Emits the events since the last emit right away.
+   */
+  void emit_now();
+
+ private:
+  struct Local;
+
+  std::atomic<std::uint64_t>* local(std::size_t series);
+  void run();
+
+  Emit emit;
+  std::chrono::milliseconds period;
+  std::uint64_t id;
+
+  std::mutex mutex;
+  std::vector<std::string> names;
+  std::vector<std::shared_ptr<Local>> locals;
+  std::vector<telemetry::Histogram> retired;
+  std::vector<telemetry::Histogram> emitted;
+
+  std::mutex emit_mutex;
+  std::condition_variable wake;
+  bool done = false;
+  std::thread thread;
+};
+
+/**
+ * @brief Handle of one series of a LatencySummary.
+ */
+class LatencySeries {
+ public:
+  LatencySeries(LatencySummary& summary, std::size_t index) : summary(&summary), index(index) {}
+
+  /**
+   * @brief Records an event that took ns nanoseconds.
+   */
+  void record(std::uint64_t ns) { summary->record(index, ns); }
+
+  /**
+   * @brief Records the time until the end of its scope.
+   */
+  class Scope {
+   public:
+    Scope(LatencySummary* summary, std::size_t index)
+        : summary(summary), index(index), started(std::chrono::steady_clock::now()) {}
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() {
+      summary->record(index, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - started)
+                                 .count());
+    }
+
+   private:
+    LatencySummary* summary;
+    std::size_t index;
+    std::chrono::steady_clock::time_point started;
+  };
+
+  /**
+   * @brief Starts timing an event, recorded when the returned scope ends.
+   */
+  Scope time() { return Scope(summary, index); }
+
+ private:
+  LatencySummary* summary;
+  std::size_t index;
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_TIMING_HPP
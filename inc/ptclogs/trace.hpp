@@ -0,0 +1,97 @@
+#ifndef PTCLOGS_TRACE_HPP
+#define PTCLOGS_TRACE_HPP
+#include <exception>
+#include <string>
+#include <string_view>
+
+#include "ptclogs/value.hpp"
+
+namespace logger {
+/**
+ * @brief Return addresses of the current stack, logged as an array of
+ * module+0xoffset frames.
+ *
+ * Capturing only walks the stack with the unwinder and rendering only looks
+ * up the module of each address in a cached table, so neither reads debug
+ * information. Frames are symbolized afterwards, off the logging thread, by
+ * ptclogs-symbolize, which keeps working when the binaries are moved or the
+ * process is gone as long as the same builds are at hand.
+ *
+ * Usage:
+ *   logger.ERROR("request failed", Field("stack", StackTrace::capture()));
+ *   // "stack":["/srv/app+0x4f1c2","/lib/x86_64-linux-gnu/libc.so.6+0x29d90",...]
+ */
+struct StackTrace {
+  static constexpr int max_frames = 32;
+
+  /**
+   * @brief Captures the stack of the calling thread.
+   *
+   * @param skip Innermost frames left out, besides capture itself.
+   */
+  static StackTrace capture(int skip = 0);
+
+  int size = 0;
+  void* frames[max_frames];
+};
+
+/**
+ * @brief Type and message of an exception.
+ */
+struct ExceptionInfo {
+  std::string type;
+  std::string what;
+  /**
+   * @brief Whether it derives from std::exception, so what is set.
+   */
+  bool standard = false;
+};
+
+namespace trace {
+/**
+ * @brief Returns the frame an address is logged as, module+0xoffset with the
+ * offset relative to the load address of the module, or the bare address
+ * when it isn't in a loaded module. The view is valid until the next call
+ * on the same thread.
+ */
+std::string_view frame(const void* address);
+
+/**
+ * @brief Returns the demangled type and the message of the exception held by
+ * error, by rethrowing it.
+ */
+ExceptionInfo inspect(const std::exception_ptr& error);
+};  // namespace trace
+
+template <>
+struct serializer<StackTrace> {
+  template <class Writer>
+  static void write(Writer& w, const StackTrace& trace) {
+    w.value(StreamArray([&](auto& array) {
+      for (int i = 0; i < trace.size; i++) array.push(trace::frame(trace.frames[i]));
+    }));
+  }
+};
+
+/**
+ * @brief Logs an exception as an object with its type and what(), or null
+ * when empty.
+ *
+ * Usage:
+ *   catch (...) {
+ *     logger.ERROR("job failed", Field("error", std::current_exception()));
+ *   }  // "error":{"type":"std::out_of_range","what":"vector::_M_range_check"}
+ */
+template <>
+struct serializer<std::exception_ptr> {
+  template <class Writer>
+  static void write(Writer& w, const std::exception_ptr& error) {
+    if (!error) return;
+    ExceptionInfo info = trace::inspect(error);
+    w.field("type", info.type);
+    if (info.standard) w.field("what", info.what);
+  }
+};
+};  // namespace logger
+
+#endif  // PTCLOGS_TRACE_HPP
@@ -0,0 +1,405 @@
+#ifndef PTCLOGS_VALUE_HPP
+#define PTCLOGS_VALUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "ptclogs/driver/idriver.hpp"
+
+namespace logger {
+
+/**
+ * @brief Nested object made of fields, logged as a structured value.
+ *
+ * Usage:
+ *   logger.INFO("login", Field("user", Object(Field<int>("id", 12),
+ *                                             Field<std::string>("name", "ana"))));
+ *
+ * @tparam Ts Types of the fields of the object.
+ */
+template <typename... Ts>
+class Object {
+ public:
+  Object(Field<Ts>... fields) : fields(fields...){};
+  std::tuple<Field<Ts>...> fields;
+};
+
+/**
+ * @brief Array whose elements are produced while the record is written, so
+ * large arrays never have to be materialized in a container.
+ *
+ * Usage:
+ *   logger.INFO("batch", Field("ids", StreamArray([&](auto& array) {
+ *     for (auto& item : items) array.push(item.id);
+ *   })));
+ *
+ * @tparam F Callable taking an ArrayWriter.
+ */
+template <typename F>
+class StreamArray {
+ public:
+  StreamArray(F fill) : fill(fill){};
+  F fill;
+};
+
+/**
+ * @brief Value computed only when the record holding it is written, for
+ * fields that are expensive to produce.
+ *
+ * The callable runs at most once per Lazy, however many times the value is
+ * written, and never when the record is filtered out by its level or dropped
+ * by a sampled logger. A context field with a lazy value is computed by the
+ * first record written and reused by the later ones. Records held back by a
+ * sampled logger compute it when the request is kept, so what the callable
+ * refers to has to outlive the request.
+ *
+ * Usage:
+ *   logger.DEBUG("queue", Field("items", Lazy([&] { return queue.dump(); })));
+ *
+ * @tparam F Callable taking no arguments.
+ */
+template <typename F>
+class Lazy {
+ public:
+  using result_type = std::decay_t<std::invoke_result_t<F&>>;
+
+  Lazy(F compute) : compute(std::move(compute)){};
+
+  Lazy(const Lazy& other) : compute(other.compute) {
+    if (other.state.load(std::memory_order_acquire) == READY) {
+      result = other.result;
+      state.store(READY, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Returns the value, computing it on the first call. Concurrent
+   * callers wait for the one computing it.
+   */
+  const result_type& get() const {
+    if (state.load(std::memory_order_acquire) != READY) {
+      unsigned char expected = EMPTY;
+      if (state.compare_exchange_strong(expected, BUSY, std::memory_order_acquire)) {
+        try {
+          result.emplace(compute());
+        } catch (...) {
+          state.store(EMPTY, std::memory_order_release);
+          throw;
+        }
+        state.store(READY, std::memory_order_release);
+      } else {
+        while (state.load(std::memory_order_acquire) != READY) std::this_thread::yield();
+      }
+    }
+    return *result;
+  }
+
+ private:
+  enum : unsigned char { EMPTY, BUSY, READY };
+
+  mutable F compute;
+  mutable std::optional<result_type> result;
+  mutable std::atomic<unsigned char> state{EMPTY};
+};
+
+template <class Driver, typename T>
+void write_value(Driver& driver, const T& value);
+
+/**
+ * @brief Appends elements to an array that is being written by Driver.
+ */
+template <class Driver>
+class ArrayWriter {
+ public:
+  ArrayWriter(Driver& driver) : driver(driver){};
+
+  /**
+   * @brief Writes the next element of the array.
+   *
+   * @param value Element that will be written.
+   */
+  template <typename T>
+  void push(const T& value) {
+    if (count++) driver.value_separator();
+    write_value(driver, value);
+  }
+
+ private:
+  Driver& driver;
+  std::size_t count = 0;
+};
+
+/**
+ * @brief Customization point describing how T is logged.
+ *
+ * Specialize it with a static write function that describes the value
+ * through a ValueWriter, either as a single value or as typed fields. It is
+ * resolved at compile time for every driver, without virtual calls or
+ * std::ostream.
+ *
+ * Usage:
+ *   template <>
+ *   struct logger::serializer<UserId> {
+ *     template <class Writer>
+ *     static void write(Writer& w, const UserId& id) { w.value(id.str()); }
+ *   };
+ *
+ *   template <>
+ *   struct logger::serializer<Point> {
+ *     template <class Writer>
+ *     static void write(Writer& w, const Point& p) {
+ *       w.field("x", p.x);
+ *       w.field("y", p.y);
+ *     }
+ *   };
+ */
+template <typename T, typename = void>
+struct serializer;
+
+/**
+ * @brief Pointer to a data member together with the key it is logged as.
+ */
+template <class C, typename M>
+struct Member {
+  std::string_view name;
+  M C::*pointer;
+};
+
+/**
+ * @brief Describes a data member for reflect.
+ *
+ * @param name Key the member is logged as.
+ * @param pointer Pointer to the member.
+ */
+template <class C, typename M>
+constexpr Member<C, M> member(std::string_view name, M C::*pointer) {
+  return Member<C, M>{name, pointer};
+}
+
+/**
+ * @brief Describes the members of a struct once, so it is logged as an object
+ * with one field per member.
+ *
+ * Usage:
+ *   template <>
+ *   struct logger::reflect<Point> {
+ *     static constexpr auto members =
+ *         std::make_tuple(ptclogs_member(Point, x), ptclogs_member(Point, y));
+ *   };
+ */
+template <typename T>
+struct reflect;
+
+#define ptclogs_member(Type, name) logger::member(#name, &Type::name)
+
+/**
+ * @brief Writer handed to serializer specializations.
+ *
+ * Calling value writes a single value, calling field turns the value into an
+ * object and appends a field to it. A serializer does one or the other:
+ * whatever is called after a value, and a value after fields, is ignored,
+ * so the record stays well formed.
+ */
+template <class Driver>
+class ValueWriter {
+ public:
+  ValueWriter(Driver& driver) : driver(driver){};
+
+  /**
+   * @brief Writes the value as a single value.
+   */
+  template <typename T>
+  void value(const T& value) {
+    if (written) return;
+    write_value(driver, value);
+    written = true;
+  }
+
+  /**
+   * @brief Appends a field to the object being written.
+   *
+   * @param key Key of the field.
+   * @param value Value of the field.
+   */
+  template <typename T>
+  void field(std::string_view key, const T& value) {
+    if (written && !object) return;
+    if (object)
+      driver.value_separator();
+    else
+      driver.begin_object();
+    object = written = true;
+    driver.write_key(key);
+    write_value(driver, value);
+  }
+
+  /**
+   * @brief Closes the object, if fields were written.
+   */
+  void finish() {
+    if (object)
+      driver.end_object();
+    else if (!written)
+      driver.write_null();
+  }
+
+ private:
+  Driver& driver;
+  bool object = false;
+  bool written = false;
+};
+
+template <typename T, typename = void>
+struct has_serializer : std::false_type {};
+template <typename T>
+struct has_serializer<T, std::void_t<decltype(sizeof(serializer<T>))>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct is_reflected : std::false_type {};
+template <typename T>
+struct is_reflected<T, std::void_t<decltype(reflect<T>::members)>>
+    : std::true_type {};
+
+// nullptr converts to std::string_view until C++23, but it is written as null
+template <typename T>
+struct is_string_like
+    : std::integral_constant<
+          bool, (std::is_convertible<const T&, std::string_view>::value ||
+                 std::is_same<std::decay_t<T>, char*>::value) &&
+                    !std::is_null_pointer<T>::value> {};
+
+template <typename T, typename = void>
+struct is_iterable : std::false_type {};
+template <typename T>
+struct is_iterable<T, std::void_t<decltype(std::begin(std::declval<const T&>())),
+                                  decltype(std::end(std::declval<const T&>()))>>
+    : std::true_type {};
+
+template <typename T, typename = void>
+struct is_map_like : std::false_type {};
+template <typename T>
+struct is_map_like<T, std::void_t<typename T::key_type, typename T::mapped_type>>
+    : is_iterable<T> {};
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct is_variant : std::false_type {};
+template <typename... Ts>
+struct is_variant<std::variant<Ts...>> : std::true_type {};
+
+template <typename T>
+struct is_object : std::false_type {};
+template <typename... Ts>
+struct is_object<Object<Ts...>> : std::true_type {};
+
+template <typename T>
+struct is_lazy : std::false_type {};
+template <typename F>
+struct is_lazy<Lazy<F>> : std::true_type {};
+
+template <typename T>
+struct is_stream_array : std::false_type {};
+template <typename F>
+struct is_stream_array<StreamArray<F>> : std::true_type {};
+
+/**
+ * @brief Writes value through the structural primitives of Driver.
+ *
+ * Types with a serializer specialization or a reflect description are
+ * written through it. Strings, numbers, booleans, std::optional,
+ * std::variant, maps, iterable containers, Object and StreamArray are
+ * rendered natively, and Lazy values as what they compute. Anything else is
+ * handed to Driver::write_raw, which streams it with operator<<.
+ *
+ * @tparam Driver Driver that renders the value.
+ * @tparam T Type of the value.
+ */
+template <class Driver, typename T>
+void write_value(Driver& driver, const T& value) {
+  if constexpr (has_serializer<T>::value) {
+    ValueWriter<Driver> writer(driver);
+    serializer<T>::write(writer, value);
+    writer.finish();
+  } else if constexpr (is_reflected<T>::value) {
+    driver.begin_object();
+    std::apply(
+        [&](const auto&... members) {
+          std::size_t count = 0;
+          ((count++ ? driver.value_separator() : void(), driver.write_key(members.name),
+            write_value(driver, value.*(members.pointer))),
+           ...);
+        },
+        reflect<T>::members);
+    driver.end_object();
+  } else if constexpr (is_string_like<T>::value) {
+    driver.write_string(std::string_view(value));
+  } else if constexpr (std::is_same<T, bool>::value) {
+    driver.write_bool(value);
+  } else if constexpr (std::is_same<T, char>::value) {
+    driver.write_string(std::string_view(&value, 1));
+  } else if constexpr (std::is_arithmetic<T>::value) {
+    driver.write_number(value);
+  } else if constexpr (std::is_same<T, std::nullptr_t>::value ||
+                       std::is_same<T, std::nullopt_t>::value ||
+                       std::is_same<T, std::monostate>::value) {
+    driver.write_null();
+  } else if constexpr (is_optional<T>::value) {
+    if (value)
+      write_value(driver, *value);
+    else
+      driver.write_null();
+  } else if constexpr (is_variant<T>::value) {
+    std::visit([&driver](const auto& v) { write_value(driver, v); }, value);
+  } else if constexpr (is_object<T>::value) {
+    driver.begin_object();
+    std::size_t count = 0;
+    std::apply(
+        [&](const auto&... fields) {
+          ((count++ ? driver.value_separator() : void(), driver.write_key(fields.header),
+            write_value(driver, fields.value)),
+           ...);
+        },
+        value.fields);
+    driver.end_object();
+  } else if constexpr (is_lazy<T>::value) {
+    write_value(driver, value.get());
+  } else if constexpr (is_stream_array<T>::value) {
+    driver.begin_array();
+    ArrayWriter<Driver> array(driver);
+    value.fill(array);
+    driver.end_array();
+  } else if constexpr (is_map_like<T>::value) {
+    driver.begin_object();
+    std::size_t count = 0;
+    for (const auto& entry : value) {
+      if (count++) driver.value_separator();
+      driver.write_key(entry.first);
+      write_value(driver, entry.second);
+    }
+    driver.end_object();
+  } else if constexpr (is_iterable<T>::value) {
+    driver.begin_array();
+    ArrayWriter<Driver> array(driver);
+    for (const auto& element : value) array.push(element);
+    driver.end_array();
+  } else {
+    driver.write_raw(value);
+  }
+}
+};  // namespace logger
+
+#endif  // PTCLOGS_VALUE_HPP
@@ -0,0 +1,84 @@
+#include "ptclogs/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "ptclogs/memory.hpp"
+
+namespace {
+using Block = logger::Arena::Block;
+
+void deallocate(Block* block) {
+    block->resource->deallocate(block, block->size, alignof(std::max_align_t));
+}
+
+/**
+ * @brief Free pooled blocks of a thread, capped so a burst doesn't pin memory
+ * forever.
+ */
+struct Pool {
+    static constexpr std::size_t max_blocks = 256;
+    Block* free = nullptr;
+    std::size_t count = 0;
+
+    ~Pool() {
+	logger::memory::pooled(-std::int64_t(count * logger::Arena::block_size));
+	while (free) {
+	    Block* next = free->next;
+	    deallocate(free);
+	    free = next;
+	}
+    }
+};
+
+thread_local Pool pool;
+}  // namespace
+
+void* logger::Arena::allocate(std::size_t size, std::size_t align) {
+    std::uintptr_t at = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(align - 1);
+    if (cursor && at + size <= reinterpret_cast<std::uintptr_t>(end)) {
+	cursor = reinterpret_cast<char*>(at + size);
+	return reinterpret_cast<void*>(at);
+    }
+
+    std::size_t need = sizeof(Block) + size + align;
+    Block* block;
+    if (need <= block_size && pool.free) {
+	block = pool.free;
+	pool.free = block->next;
+	pool.count--;
+	memory::pooled(-std::int64_t(block_size));
+    } else {
+	std::size_t bytes = need <= block_size ? block_size : need;
+	std::pmr::memory_resource* resource = memory::resource();
+	block = static_cast<Block*>(resource->allocate(bytes, alignof(std::max_align_t)));
+	block->size = bytes;
+	block->resource = resource;
+    }
+    memory::arena_acquired(block->size);
+    held += block->size;
+    peak = std::max(peak, held);
+    block->next = blocks;
+    blocks = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    end = reinterpret_cast<char*>(block) + block->size;
+    return allocate(size, align);
+}
+
+void logger::Arena::release() {
+    while (blocks) {
+	Block* next = blocks->next;
+	memory::arena_released(blocks->size);
+	if (blocks->size == block_size && pool.count < Pool::max_blocks) {
+	    blocks->next = pool.free;
+	    pool.free = blocks;
+	    pool.count++;
+	    memory::pooled(block_size);
+	} else {
+	    deallocate(blocks);
+	}
+	blocks = next;
+    }
+    held = 0;
+    cursor = end = nullptr;
+}
@@ -0,0 +1,120 @@
+#include "ptclogs/sink/async_buffer.hpp"
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "ptclogs/telemetry.hpp"
+
+logger::AsyncBuffer::AsyncBuffer(int fd, OverflowPolicy policy, DropReporter reporter)
+    : fd(fd), queue(policy), reporter(reporter) {
+    writer = std::thread(&AsyncBuffer::run, this);
+}
+
+logger::AsyncBuffer::~AsyncBuffer() {
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+    }
+    has_records.notify_one();
+    writer.join();
+}
+
+std::size_t logger::AsyncBuffer::pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+void logger::AsyncBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!enqueue(lock, level, data, size)) return;
+    lock.unlock();
+    has_records.notify_one();
+}
+
+void logger::AsyncBuffer::commit_batch(const char* data, const BatchRecord* records,
+				       std::size_t count) {
+    // one lock and one wake up for the whole batch
+    std::unique_lock<std::mutex> lock(mutex);
+    bool queued = false;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < count; i++) {
+	queued |= enqueue(lock, records[i].level, data + start, records[i].end - start);
+	start = records[i].end;
+    }
+    lock.unlock();
+    if (queued) has_records.notify_one();
+}
+
+bool logger::AsyncBuffer::enqueue(std::unique_lock<std::mutex>& lock, LogLevel level,
+				  const char* data, std::size_t size) {
+    auto deadline = std::chrono::steady_clock::now() + queue.get_policy().timeout;
+    while (true) {
+	bool expired = std::chrono::steady_clock::now() >= deadline;
+	switch (queue.admit(level, size, expired)) {
+	    case RecordQueue::ADMIT:
+		queue.push(level, data, size);
+		return true;
+	    case RecordQueue::DROP:
+		queue.drop(level);
+		return false;
+	    case RecordQueue::WAIT:
+		// the writer may be waiting for these records to make room
+		has_records.notify_one();
+		if (queue.get_policy().mode == OverflowMode::BLOCK_TIMEOUT)
+		    has_room.wait_until(lock, deadline);
+		else
+		    has_room.wait(lock);
+		break;
+	}
+    }
+}
+
+void logger::AsyncBuffer::write_all(const char* data, std::size_t size) {
+    while (size > 0) {
+	ssize_t n = write(fd, data, size);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+		pollfd p{fd, POLLOUT, 0};
+		poll(&p, 1, -1);
+		continue;
+	    }
+	    return;
+	}
+	data += n;
+	size -= n;
+    }
+}
+
+void logger::AsyncBuffer::run() {
+    std::pmr::deque<RecordQueue::Record> batch(memory::resource());
+    std::string out;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+	has_records.wait(lock, [this] { return done || !queue.empty(); });
+	if (queue.empty() && done) return;
+
+	queue.take(batch);
+	lock.unlock();
+	has_room.notify_all();
+
+	out.clear();
+	for (auto& record : batch) out += record.data;
+	write_all(out.data(), out.size());
+	telemetry::flush();
+	lock.lock();
+
+	// drops are reported once the queue drained, not while still under
+	// pressure, where the report would only add to it
+	DropCounts counts;
+	if (queue.empty() && queue.take_drops(counts)) {
+	    lock.unlock();
+	    std::string report = reporter(counts);
+	    write_all(report.data(), report.size());
+	    lock.lock();
+	}
+    }
+}
@@ -0,0 +1,229 @@
+#include "ptclogs/callsite.hpp"
+
+#include <fnmatch.h>
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+using logger::CallSite;
+
+struct Registry {
+    std::mutex mutex;
+    CallSite* sites = nullptr;
+    std::vector<std::pair<std::string, CallSite::State>> rules;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry();  // sites may run during static destruction
+    return *r;
+}
+
+/**
+ * @brief Matches pattern against the function and against "file:line", with
+ * file both as given by __FILE__ and as its last component, so
+ * "cache.cpp:*" matches sites in src/cache.cpp.
+ */
+bool matches(const CallSite& site, const std::string& pattern) {
+    std::string where = std::string(site.file) + ":" + std::to_string(site.line);
+    const char* base = strrchr(site.file, '/');
+    if (fnmatch(pattern.c_str(), where.c_str(), 0) == 0 ||
+	fnmatch(pattern.c_str(), site.function, 0) == 0)
+	return true;
+    return base && fnmatch(pattern.c_str(), where.c_str() + (base + 1 - site.file), 0) == 0;
+}
+
+/**
+ * @brief Parses "+pattern", "-pattern" or "=pattern".
+ *
+ * @return Whether the rule is well formed.
+ */
+bool parse(std::string_view rule, std::string_view& pattern, CallSite::State& state) {
+    if (rule.size() < 2) return false;
+    switch (rule[0]) {
+	case '+':
+	    state = CallSite::ON;
+	    break;
+	case '-':
+	    state = CallSite::OFF;
+	    break;
+	case '=':
+	    state = CallSite::DEFAULT;
+	    break;
+	default:
+	    return false;
+    }
+    pattern = rule.substr(1);
+    return true;
+}
+
+/**
+ * @brief Appends a rule. An earlier rule with the same pattern is overridden
+ * by it everywhere, so it is removed and the list only grows with distinct
+ * patterns.
+ */
+void add_rule(Registry& r, std::string_view pattern, CallSite::State state) {
+    std::erase_if(r.rules, [&](const auto& rule) { return rule.first == pattern; });
+    r.rules.emplace_back(std::string(pattern), state);
+}
+/**
+ * @brief Reads the rules of the control file at path if it changed since
+ * seen and size, which are updated.
+ */
+void reload(const std::string& path, struct timespec& seen, off_t& size) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return;
+    if (st.st_mtim.tv_sec == seen.tv_sec && st.st_mtim.tv_nsec == seen.tv_nsec && st.st_size == size)
+	return;
+    seen = st.st_mtim;
+    size = st.st_size;
+
+    std::ifstream file(path);
+    if (!file) return;
+    std::vector<std::string> rules;
+    std::string line;
+    while (std::getline(file, line)) {
+	while (!line.empty() && (line.back() == ' ' || line.back() == '\r')) line.pop_back();
+	if (line.empty() || line[0] == '#') continue;
+	rules.push_back(line);
+    }
+    logger::callsites::replace(rules);
+}
+
+/**
+ * @brief The one thread polling a control file. watch and unwatch are
+ * serialized by control, the thread and they share the rest under mutex.
+ */
+struct Watcher {
+    std::mutex control;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::string path;
+    std::chrono::milliseconds interval{};
+    bool stopped = false;
+    std::thread thread;
+
+    ~Watcher() { stop(); }
+
+    void run() {
+	struct timespec seen = {-1, 0};
+	off_t size = -1;
+	std::string watched;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopped) {
+	    if (path != watched) {
+		// a new file is read whatever its times
+		watched = path;
+		seen = {-1, 0};
+		size = -1;
+	    }
+	    lock.unlock();
+	    reload(watched, seen, size);
+	    lock.lock();
+	    changed.wait_for(lock, interval, [&] { return stopped || path != watched; });
+	}
+    }
+
+    void stop() {
+	std::lock_guard<std::mutex> serialized(control);
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    stopped = true;
+	}
+	changed.notify_all();
+	if (thread.joinable()) thread.join();
+    }
+};
+
+Watcher& watcher() {
+    static Watcher w;  // stopped and joined at exit
+    return w;
+}
+}  // namespace
+
+logger::CallSite::State logger::CallSite::enroll() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    State s = state.load(std::memory_order_relaxed);
+    if (s != NEW) return s;
+    s = DEFAULT;
+    for (auto& rule : r.rules)
+	if (matches(*this, rule.first)) s = rule.second;
+    next = r.sites;
+    r.sites = this;
+    state.store(s, std::memory_order_relaxed);
+    return s;
+}
+
+std::size_t logger::callsites::set(std::string_view pattern, CallSite::State state) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    add_rule(r, pattern, state);
+    std::size_t changed = 0;
+    for (CallSite* site = r.sites; site; site = site->next)
+	if (matches(*site, r.rules.back().first)) {
+	    site->state.store(state, std::memory_order_relaxed);
+	    changed++;
+	}
+    return changed;
+}
+
+long logger::callsites::apply(std::string_view rule) {
+    std::string_view pattern;
+    CallSite::State state;
+    if (!parse(rule, pattern, state)) return -1;
+    return set(pattern, state);
+}
+
+void logger::callsites::replace(const std::vector<std::string>& rules) {
+    Registry fresh;
+    for (auto& rule : rules) {
+	std::string_view pattern;
+	CallSite::State state;
+	if (parse(rule, pattern, state)) add_rule(fresh, pattern, state);
+    }
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.rules = std::move(fresh.rules);
+    for (CallSite* site = r.sites; site; site = site->next) {
+	CallSite::State s = CallSite::DEFAULT;
+	for (auto& rule : r.rules)
+	    if (matches(*site, rule.first)) s = rule.second;
+	site->state.store(s, std::memory_order_relaxed);
+    }
+}
+
+void logger::callsites::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.rules.clear();
+    for (CallSite* site = r.sites; site; site = site->next)
+	site->state.store(CallSite::DEFAULT, std::memory_order_relaxed);
+}
+
+void logger::callsites::for_each(const std::function<void(const CallSite&)>& f) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (CallSite* site = r.sites; site; site = site->next) f(*site);
+}
+
+void logger::callsites::watch(const std::string& path, std::chrono::milliseconds interval) {
+    Watcher& w = watcher();
+    std::lock_guard<std::mutex> control(w.control);
+    {
+	std::lock_guard<std::mutex> lock(w.mutex);
+	w.path = path;
+	w.interval = interval;
+	w.stopped = false;
+    }
+    w.changed.notify_all();
+    if (!w.thread.joinable()) w.thread = std::thread(&Watcher::run, &w);
+}
+
+void logger::callsites::unwatch() { watcher().stop(); }
@@ -0,0 +1,178 @@
+#include "ptclogs/clock.hpp"
+
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(PTCLOGS_TSC) && defined(__x86_64__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PTCLOGS_HAS_TSC
+#endif
+
+namespace {
+std::int64_t read_ns(clockid_t id) {
+    timespec ts;
+    clock_gettime(id, &ts);
+    return std::int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+std::int64_t realtime_ns() { return read_ns(CLOCK_REALTIME); }
+
+#ifdef PTCLOGS_HAS_TSC
+/**
+ * @brief Simultaneous TSC and CLOCK_MONOTONIC_RAW readings, and the offset of
+ * CLOCK_REALTIME from CLOCK_MONOTONIC_RAW at that time.
+ */
+struct Sample {
+    std::uint64_t tsc;
+    std::int64_t raw;
+    std::int64_t offset;
+};
+
+/**
+ * @brief Reads the clocks, keeping the attempt where the OS clock call was
+ * the fastest and taking the TSC in the middle of it.
+ */
+Sample sample() {
+    Sample best{};
+    std::uint64_t best_width = UINT64_MAX;
+    for (int i = 0; i < 5; i++) {
+	std::uint64_t before = __rdtsc();
+	std::int64_t raw = read_ns(CLOCK_MONOTONIC_RAW);
+	std::uint64_t after = __rdtsc();
+	if (after - before < best_width) {
+	    best_width = after - before;
+	    best = Sample{before + (after - before) / 2, raw, realtime_ns() - raw};
+	}
+    }
+    return best;
+}
+
+/**
+ * @brief Conversion from TSC to wall time: ns = ns + (tsc - anchor) * mult >> 32.
+ * Written by the calibration thread only, under a sequence lock.
+ */
+std::atomic<std::uint32_t> sequence{0};
+std::atomic<std::uint64_t> anchor_tsc{0};
+std::atomic<std::int64_t> anchor_ns{0};
+std::atomic<std::uint64_t> mult{0};
+
+void publish(const Sample& at, std::uint64_t m) {
+    std::uint32_t s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    anchor_tsc.store(at.tsc, std::memory_order_relaxed);
+    anchor_ns.store(at.raw + at.offset, std::memory_order_relaxed);
+    mult.store(m, std::memory_order_relaxed);
+    sequence.store(s + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Nanoseconds per TSC tick, as a 32.32 fixed point number. Measured
+ * against CLOCK_MONOTONIC_RAW, which is never stepped nor slewed, so it is
+ * always increasing between samples.
+ */
+std::uint64_t rate(const Sample& from, const Sample& to) {
+    return (static_cast<unsigned __int128>(to.raw - from.raw) << 32) / (to.tsc - from.tsc);
+}
+
+/**
+ * @brief Recalibrates every second until the process exits. The rate is
+ * measured against the first sample, over an ever longer baseline, while
+ * the offset to wall time is read again on every pass, so steps and slews
+ * of CLOCK_REALTIME show up within a second without disturbing the rate.
+ */
+class Calibrator {
+   public:
+    explicit Calibrator(Sample origin) : thread(&Calibrator::run, this, origin) {}
+
+    ~Calibrator() {
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    stopping = true;
+	}
+	stop.notify_one();
+	thread.join();
+    }
+
+   private:
+    void run(Sample origin) {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stop.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; })) {
+	    Sample now = sample();
+	    publish(now, rate(origin, now));
+	}
+    }
+
+    std::mutex mutex;
+    std::condition_variable stop;
+    bool stopping = false;
+    std::thread thread;
+};
+
+bool invariant_tsc() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) return false;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return edx & (1 << 8);
+}
+
+/**
+ * @brief Detects an invariant TSC and, if there is one, does a first 1ms
+ * calibration and starts the calibration thread.
+ */
+bool start() {
+    if (!invariant_tsc()) return false;
+    Sample origin = sample();
+    Sample now;
+    do now = sample();
+    while (now.raw - origin.raw < 1000000);
+    publish(now, rate(origin, now));
+    // stopped and joined with the other statics at exit
+    static Calibrator calibrator(origin);
+    return true;
+}
+#endif
+}  // namespace
+
+bool logger::clock::tsc() {
+#ifdef PTCLOGS_HAS_TSC
+    static const bool enabled = start();
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t logger::clock::stamp() {
+#ifdef PTCLOGS_HAS_TSC
+    if (tsc()) return __rdtsc();
+#endif
+    return realtime_ns();
+}
+
+std::int64_t logger::clock::to_unix_ns(std::uint64_t stamp) {
+#ifdef PTCLOGS_HAS_TSC
+    if (tsc()) {
+	std::uint32_t s;
+	std::uint64_t base, m;
+	std::int64_t ns;
+	do {
+	    s = sequence.load(std::memory_order_acquire);
+	    base = anchor_tsc.load(std::memory_order_relaxed);
+	    ns = anchor_ns.load(std::memory_order_relaxed);
+	    m = mult.load(std::memory_order_relaxed);
+	    std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((s & 1) || s != sequence.load(std::memory_order_relaxed));
+	// stamps taken before the last calibration are behind the anchor
+	__int128 delta = std::int64_t(stamp - base);
+	return ns + std::int64_t((delta * m) >> 32);
+    }
+#endif
+    return std::int64_t(stamp);
+}
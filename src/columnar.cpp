@@ -0,0 +1,323 @@
+#include "ptclogs/columnar.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+
+namespace {
+using logger::columnar::get_varint;
+using logger::columnar::put_varint;
+
+bool is_integer(std::string_view value) {
+    std::string_view digits = value.substr(!value.empty() && value[0] == '-');
+    // 18 digits always fit an int64_t, and "-0" or "01" wouldn't come back as written
+    if (digits.empty() || digits.size() > 18) return false;
+    if (digits[0] == '0' && (digits.size() > 1 || digits.size() != value.size())) return false;
+    for (char c : digits)
+	if (c < '0' || c > '9') return false;
+    return true;
+}
+
+void put_string(std::string& out, std::string_view value) {
+    put_varint(out, value.size());
+    out.append(value);
+}
+
+bool get_string(std::string_view& in, std::string_view& value) {
+    std::uint64_t size;
+    if (!get_varint(in, size) || size > in.size()) return false;
+    value = in.substr(0, size);
+    in.remove_prefix(size);
+    return true;
+}
+
+std::size_t packed_size(std::size_t count, unsigned width) { return (count * width + 7) / 8; }
+}  // namespace
+
+void logger::columnar::put_varint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+	out.push_back(char(value | 0x80));
+	value >>= 7;
+    }
+    out.push_back(char(value));
+}
+
+bool logger::columnar::get_varint(std::string_view& in, std::uint64_t& value) {
+    value = 0;
+    for (std::size_t i = 0; i < in.size() && i < 10; i++) {
+	unsigned char byte = in[i];
+	value |= std::uint64_t(byte & 0x7f) << (7 * i);
+	if (!(byte & 0x80)) {
+	    in.remove_prefix(i + 1);
+	    return true;
+	}
+    }
+    return false;
+}
+
+void logger::columnar::pack(std::string& out, const std::vector<std::uint64_t>& values, unsigned width) {
+    std::size_t start = out.size();
+    out.resize(start + packed_size(values.size(), width));
+    unsigned char* data = reinterpret_cast<unsigned char*>(out.data() + start);
+    std::size_t bit = 0;
+    for (std::uint64_t value : values) {
+	for (unsigned done = 0; done < width;) {
+	    unsigned take = std::min(width - done, 8 - unsigned(bit % 8));
+	    data[bit / 8] |= ((value >> done) & ((1u << take) - 1)) << (bit % 8);
+	    done += take;
+	    bit += take;
+	}
+    }
+}
+
+std::uint64_t logger::columnar::unpack(std::string_view data, std::size_t index, unsigned width) {
+    std::uint64_t value = 0;
+    std::size_t bit = index * width;
+    for (unsigned done = 0; done < width;) {
+	unsigned take = std::min(width - done, 8 - unsigned(bit % 8));
+	unsigned char byte = data[bit / 8];
+	value |= std::uint64_t((byte >> (bit % 8)) & ((1u << take) - 1)) << done;
+	done += take;
+	bit += take;
+    }
+    return value;
+}
+
+logger::columnar::BlockBuilder::BlockBuilder(std::vector<std::string> keys, std::uint8_t flags,
+					     const SegmentOptions& options)
+    : keys(std::move(keys)), flags(flags), max_dictionary(options.max_dictionary) {
+    columns.resize(this->keys.size());
+}
+
+void logger::columnar::BlockBuilder::add_record(std::int64_t ns, LogLevel level) {
+    timestamps.push_back(ns);
+    levels.push_back(level);
+}
+
+void logger::columnar::BlockBuilder::add_value(std::size_t column, std::string_view value,
+					       bool quoted) {
+    Pending& c = columns[column];
+    c.bytes.append(value);
+    c.ends.push_back(c.bytes.size());
+    c.quoted.push_back(quoted);
+    if (quoted) {
+	c.any_quoted = true;
+	c.integers = false;
+    } else {
+	c.any_literal = true;
+	c.integers = c.integers && is_integer(value);
+    }
+}
+
+void logger::columnar::BlockBuilder::encode_column(std::string& out, Pending& column) {
+    std::size_t count = column.ends.size();
+    auto value = [&](std::size_t i) {
+	std::uint32_t begin = i ? column.ends[i - 1] : 0;
+	return std::string_view(column.bytes).substr(begin, column.ends[i] - begin);
+    };
+
+    // integers take whichever of INT and DICT is smaller
+    std::string ints;
+    if (column.integers && count > 0) {
+	std::vector<std::uint64_t> values(count);
+	std::int64_t min = INT64_MAX;
+	for (std::size_t i = 0; i < count; i++) {
+	    std::string_view text = value(i);
+	    std::int64_t v = 0;
+	    std::from_chars(text.data(), text.data() + text.size(), v);
+	    values[i] = std::uint64_t(v);
+	    min = std::min(min, v);
+	}
+	std::uint64_t max = 0;
+	for (auto& v : values) max = std::max(max, v -= std::uint64_t(min));
+	unsigned width = bit_width(max);
+	ints.push_back(char(INT));
+	put_varint(ints, zigzag(min));
+	ints.push_back(char(width));
+	pack(ints, values, width);
+    }
+
+    // a column mixing strings and literals keeps the quotes of its strings
+    if (column.any_quoted && column.any_literal) {
+	Pending literals;
+	for (std::size_t i = 0; i < count; i++) {
+	    if (column.quoted[i]) literals.bytes.push_back('"');
+	    literals.bytes.append(value(i));
+	    if (column.quoted[i]) literals.bytes.push_back('"');
+	    literals.ends.push_back(literals.bytes.size());
+	}
+	column.bytes.swap(literals.bytes);
+	column.ends.swap(literals.ends);
+    }
+    std::uint8_t quoted = column.any_quoted && !column.any_literal ? QUOTED : 0;
+
+    std::unordered_map<std::string_view, std::uint32_t> dictionary;
+    std::vector<std::string_view> order;
+    std::vector<std::uint64_t> indices(count);
+    bool fits = true;
+    for (std::size_t i = 0; i < count && fits; i++) {
+	auto [it, added] = dictionary.try_emplace(value(i), dictionary.size());
+	if (added) order.push_back(it->first);
+	indices[i] = it->second;
+	fits = dictionary.size() <= max_dictionary && dictionary.size() <= count / 2 + 1;
+    }
+    if (fits) {
+	std::size_t start = out.size();
+	out.push_back(char(DICT | quoted));
+	put_varint(out, order.size());
+	for (auto& entry : order) put_string(out, entry);
+	unsigned width = bit_width(order.size() - 1);
+	out.push_back(char(width));
+	pack(out, indices, width);
+	if (ints.empty() || out.size() - start <= ints.size()) return;
+	out.resize(start);
+    }
+    if (!ints.empty()) {
+	out.append(ints);
+	return;
+    }
+
+    out.push_back(char(RAW | quoted));
+    for (std::size_t i = 0; i < count; i++) put_string(out, value(i));
+}
+
+void logger::columnar::BlockBuilder::encode(std::string& out) {
+    std::string body;
+    put_varint(body, records());
+    body.push_back(char(flags));
+    put_varint(body, keys.size());
+    for (auto& key : keys) put_string(body, key);
+
+    std::string column;
+    std::int64_t previous = 0, delta = 0;
+    for (std::size_t i = 0; i < timestamps.size(); i++) {
+	std::int64_t d = i ? timestamps[i] - previous : timestamps[i];
+	put_varint(column, zigzag(i ? d - delta : d));
+	previous = timestamps[i];
+	delta = i ? d : 0;
+    }
+    put_string(body, column);
+
+    column.clear();
+    column.push_back(char(3));
+    pack(column, levels, 3);
+    put_string(body, column);
+
+    for (auto& pending : columns) {
+	column.clear();
+	encode_column(column, pending);
+	put_string(body, column);
+	pending = Pending();
+    }
+
+    put_varint(out, body.size());
+    out.append(body);
+    timestamps.clear();
+    levels.clear();
+}
+
+bool logger::columnar::Column::values(std::size_t count, std::vector<std::string_view>& out,
+				      std::vector<std::string>& storage, bool& quoted) const {
+    out.clear();
+    storage.clear();
+    std::string_view in = data;
+    if (in.empty()) return false;
+    std::uint8_t encoding = in[0];
+    in.remove_prefix(1);
+    quoted = encoding & QUOTED;
+
+    switch (encoding & ~QUOTED) {
+	case INT: {
+	    std::uint64_t min;
+	    if (!get_varint(in, min) || in.empty()) return false;
+	    unsigned width = static_cast<unsigned char>(in[0]);
+	    in.remove_prefix(1);
+	    if (width > 64 || in.size() < packed_size(count, width)) return false;
+	    storage.resize(count);
+	    for (std::size_t i = 0; i < count; i++) {
+		storage[i] = std::to_string(std::int64_t(unpack(in, i, width) + std::uint64_t(unzigzag(min))));
+		out.push_back(storage[i]);
+	    }
+	    return true;
+	}
+	case DICT: {
+	    std::uint64_t size;
+	    if (!get_varint(in, size) || size > in.size()) return false;
+	    std::vector<std::string_view> dictionary(size);
+	    for (auto& entry : dictionary)
+		if (!get_string(in, entry)) return false;
+	    if (in.empty()) return false;
+	    unsigned width = static_cast<unsigned char>(in[0]);
+	    in.remove_prefix(1);
+	    if (width > 64 || in.size() < packed_size(count, width)) return false;
+	    for (std::size_t i = 0; i < count; i++) {
+		std::uint64_t index = unpack(in, i, width);
+		if (index >= dictionary.size()) return false;
+		out.push_back(dictionary[index]);
+	    }
+	    return true;
+	}
+	case RAW: {
+	    std::string_view value;
+	    for (std::size_t i = 0; i < count; i++) {
+		if (!get_string(in, value)) return false;
+		out.push_back(value);
+	    }
+	    return true;
+	}
+    }
+    return false;
+}
+
+bool logger::columnar::Block::parse(std::string_view& in) {
+    std::uint64_t size, count, key_count;
+    if (!get_varint(in, size) || size > in.size()) return false;
+    std::string_view body = in.substr(0, size);
+    in.remove_prefix(size);
+
+    if (!get_varint(body, count) || body.empty()) return false;
+    records = count;
+    flags = body[0];
+    body.remove_prefix(1);
+    if (!get_varint(body, key_count)) return false;
+    columns.resize(key_count);
+    for (auto& column : columns)
+	if (!get_string(body, column.key)) return false;
+    ts.key = "ts";
+    level.key = "level";
+    if (!get_string(body, ts.data) || !get_string(body, level.data)) return false;
+    for (auto& column : columns)
+	if (!get_string(body, column.data)) return false;
+    return true;
+}
+
+const logger::columnar::Column* logger::columnar::Block::find(std::string_view key) const {
+    for (auto& column : columns)
+	if (column.key == key) return &column;
+    return nullptr;
+}
+
+bool logger::columnar::Block::timestamps(std::vector<std::int64_t>& out) const {
+    out.clear();
+    std::string_view in = ts.data;
+    std::int64_t previous = 0, delta = 0;
+    for (std::size_t i = 0; i < records; i++) {
+	std::uint64_t v;
+	if (!get_varint(in, v)) return false;
+	std::int64_t d = i ? delta + unzigzag(v) : unzigzag(v);
+	previous = i ? previous + d : d;
+	delta = i ? d : 0;
+	out.push_back(previous);
+    }
+    return true;
+}
+
+bool logger::columnar::Block::levels(std::vector<LogLevel>& out) const {
+    out.clear();
+    if (level.data.empty()) return false;
+    unsigned width = static_cast<unsigned char>(level.data[0]);
+    std::string_view packed = level.data.substr(1);
+    if (packed.size() < packed_size(records, width)) return false;
+    for (std::size_t i = 0; i < records; i++) out.push_back(LogLevel(unpack(packed, i, width)));
+    return true;
+}
@@ -0,0 +1,132 @@
+#include "ptclogs/sink/columnar_file.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ptclogs/clock.hpp"
+#include "ptclogs/telemetry.hpp"
+
+namespace {
+void write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+	ssize_t n = write(fd, data, size);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    return;
+	}
+	data += n;
+	size -= n;
+    }
+}
+
+/**
+ * @brief Splits a JSON object in its fields, leaving out level.
+ *
+ * @return Whether the whole line is an object of fields.
+ */
+bool split_record(std::string_view line, std::vector<logger::reader::Field>& fields) {
+    fields.clear();
+    std::size_t open = line.find_first_not_of(' ');
+    std::size_t close = line.find_last_of('}');
+    if (open == std::string_view::npos || line[open] != '{' || close == std::string_view::npos)
+	return false;
+    std::string_view rest = line.substr(open + 1, close - open - 1);
+    logger::reader::Field field;
+    while (logger::reader::next_field(rest, logger::reader::Format::JSON, field))
+	if (field.key != "level") fields.push_back(field);
+    return rest.find_first_not_of(", ") == std::string_view::npos;
+}
+}  // namespace
+
+logger::ColumnarFileBuffer::ColumnarFileBuffer(const std::string& path,
+					       columnar::SegmentOptions options)
+    : options(options) {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd >= 0 && lseek(fd, 0, SEEK_END) == 0)
+	::write_all(fd, columnar::magic, sizeof columnar::magic);
+    if (fd >= 0 && options.flush_interval.count() > 0)
+	flusher = std::thread(&ColumnarFileBuffer::run, this);
+}
+
+logger::ColumnarFileBuffer::~ColumnarFileBuffer() {
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+    }
+    wake.notify_all();
+    if (flusher.joinable()) flusher.join();
+    std::lock_guard<std::mutex> lock(mutex);
+    write_all();
+    if (fd >= 0) close(fd);
+}
+
+/**
+ * @brief Writes the blocks whose first record waited the flush interval,
+ * checking twice per interval.
+ */
+void logger::ColumnarFileBuffer::run() {
+    std::int64_t interval =
+	std::chrono::duration_cast<std::chrono::nanoseconds>(options.flush_interval).count();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!done) {
+	wake.wait_for(lock, options.flush_interval / 2);
+	std::int64_t now = clock::record_time();
+	for (auto& entry : shapes)
+	    if (entry.second.records() && now - entry.second.first_time() >= interval)
+		write_block(entry.second);
+    }
+}
+
+void logger::ColumnarFileBuffer::write_all() {
+    encoded.clear();
+    for (auto& entry : shapes)
+	if (entry.second.records()) entry.second.encode(encoded);
+    ::write_all(fd, encoded.data(), encoded.size());
+    telemetry::flush();
+}
+
+void logger::ColumnarFileBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::int64_t now = clock::record_time();
+    std::string_view line(data, size);
+    if (!line.empty() && line.back() == '\n') line.remove_suffix(1);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bool verbatim = !split_record(line, fields);
+    shape.assign(1, verbatim ? 'v' : 'j');
+    if (!verbatim)
+	for (auto& field : fields) shape.append(field.key).push_back('\0');
+
+    auto found = shapes.find(shape);
+    if (found == shapes.end()) {
+	if (shapes.size() >= options.max_shapes) {
+	    write_all();
+	    shapes.clear();
+	}
+	std::vector<std::string> keys;
+	if (verbatim)
+	    keys.emplace_back("line");
+	else
+	    for (auto& field : fields) keys.emplace_back(field.key);
+	found = shapes.emplace(shape, columnar::BlockBuilder(std::move(keys),
+							      verbatim ? columnar::VERBATIM : 0, options))
+		    .first;
+    }
+
+    columnar::BlockBuilder& block = found->second;
+    block.add_record(now, level);
+    if (verbatim)
+	block.add_value(0, line, false);
+    else
+	for (std::size_t i = 0; i < fields.size(); i++)
+	    block.add_value(i, fields[i].value, fields[i].quoted);
+
+    if (block.records() >= options.block_records) write_block(block);
+}
+
+void logger::ColumnarFileBuffer::write_block(columnar::BlockBuilder& block) {
+    encoded.clear();
+    block.encode(encoded);
+    ::write_all(fd, encoded.data(), encoded.size());
+    telemetry::flush();
+}
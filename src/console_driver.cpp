@@ -1,15 +1,5 @@
 #include "ptclogs/driver/console_driver.hpp"
 
-void logger::ConsoleDriver::begin_message() {}
-void logger::ConsoleDriver::end_message() {}
-void logger::ConsoleDriver::field_separator() { out << ", "; }
-
-void logger::ConsoleDriver::separator() { out << "\t"; }
-
-void logger::ConsoleDriver::print_message(std::string message) {
-    out << message;
-};
-
 void logger::ConsoleDriver::print_timestamp() { out << timestamp(); }
 
 void logger::ConsoleDriver::print_level(logger::LogLevel log_level) {
@@ -1,15 +1,22 @@
-#include <chrono>
+#include <time.h>
 
+#include "ptclogs/clock.hpp"
 #include "ptclogs/driver/idriver.hpp"
 
 /**
- * @brief Returns the formatted timestamp as a string.
+ * @brief Returns the formatted timestamp as a string. The formatted second
+ * is cached per thread, so most records only read the clock.
  *
  */
 std::string logger::IDriver::timestamp() {
-    time_t now;
-    time(&now);
-    char buf[sizeof "2011-10-08T07:07:09Z"];
-    strftime(buf, sizeof buf, "%FT%TZ", gmtime(&now));
+    static thread_local time_t second = -1;
+    static thread_local char buf[sizeof "2011-10-08T07:07:09Z"];
+    time_t now = clock::record_time() / 1000000000;
+    if (now != second) {
+	tm utc;
+	gmtime_r(&now, &utc);
+	strftime(buf, sizeof buf, "%FT%TZ", &utc);
+	second = now;
+    }
     return buf;
 }
@@ -0,0 +1,110 @@
+#include "ptclogs/sink/fd_buffer.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "ptclogs/telemetry.hpp"
+
+logger::FdBuffer::FdBuffer(int fd, OverflowPolicy policy, DropReporter reporter)
+    : fd(fd), queue(policy), reporter(reporter) {
+    int flags = fcntl(fd, F_GETFL);
+    if (flags != -1) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+logger::FdBuffer::~FdBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!drain()) wait_writable(-1);
+}
+
+std::size_t logger::FdBuffer::pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+bool logger::FdBuffer::wait_writable(int timeout_ms) {
+    pollfd p{fd, POLLOUT, 0};
+    return poll(&p, 1, timeout_ms) > 0;
+}
+
+/**
+ * @brief Writes as much of the overflow buffer as the descriptor accepts.
+ *
+ * @return Whether the overflow buffer is now empty.
+ */
+bool logger::FdBuffer::drain() {
+    while (!queue.empty()) {
+	const std::pmr::string& data = queue.front().data;
+	ssize_t n = write(fd, data.data(), data.size());
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+	    // the descriptor is unusable, there is nobody to report this to
+	    queue.pop();
+	    continue;
+	}
+	telemetry::flush();
+	if (size_t(n) == data.size())
+	    queue.pop();
+	else
+	    queue.consume(n);
+    }
+    DropCounts counts;
+    if (queue.take_drops(counts)) {
+	std::string report = reporter(counts);
+	queue.push(LogLevel::WARN, report.data(), report.size());
+	return drain();
+    }
+    return true;
+}
+
+void logger::FdBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (drain()) {
+	// fast path, nothing is pending so the record can go out directly
+	while (size > 0) {
+	    ssize_t n = write(fd, data, size);
+	    if (n < 0) {
+		if (errno == EINTR) continue;
+		if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+		// the rest of the record is lost, count it like an overflow
+		queue.drop(level);
+		return;
+	    }
+	    telemetry::flush();
+	    data += n;
+	    size -= n;
+	}
+	if (size == 0) return;
+	queue.push(level, data, size);
+	return;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + queue.get_policy().timeout;
+    while (true) {
+	bool expired = std::chrono::steady_clock::now() >= deadline;
+	switch (queue.admit(level, size, expired)) {
+	    case RecordQueue::ADMIT:
+		queue.push(level, data, size);
+		drain();
+		return;
+	    case RecordQueue::DROP:
+		queue.drop(level);
+		return;
+	    case RecordQueue::WAIT: {
+		int timeout_ms = -1;
+		if (queue.get_policy().mode == OverflowMode::BLOCK_TIMEOUT) {
+		    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now());
+		    timeout_ms = left.count() > 0 ? left.count() : 0;
+		}
+		wait_writable(timeout_ms);
+		drain();
+		break;
+	    }
+	}
+    }
+}
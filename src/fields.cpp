@@ -4,3 +4,27 @@
 #include <sstream>
 
 #include "ptclogs/driver/idriver.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+thread_local int tid = 0;
+
+// the child of a fork runs as the thread that forked, under a new id
+const int forget_tid = pthread_atfork(nullptr, nullptr, [] { tid = 0; });
+}  // namespace
+
+int logger::thread_id() {
+    if (tid == 0) tid = syscall(SYS_gettid);
+    return tid;
+}
+
+int logger::cpu_id() {
+    static thread_local int cpu = -1;
+    static thread_local unsigned calls = 0;
+    if ((calls++ & 63) == 0) cpu = sched_getcpu();
+    return cpu;
+}
@@ -0,0 +1,74 @@
+#include "ptclogs/index.hpp"
+
+#include <cstring>
+#include <fstream>
+
+std::string_view logger::index::find_value(std::string_view record, std::string_view key) {
+    for (std::size_t at = record.find(key); at != std::string_view::npos;
+	 at = record.find(key, at + 1)) {
+	std::size_t end = at + key.size();
+	if (at == 0 || record[at - 1] != '"' || record.substr(end, 2) != "\":") continue;
+
+	std::size_t start = end + 2;
+	if (start < record.size() && record[start] == '"') {
+	    std::size_t close = ++start;
+	    while (close < record.size() && record[close] != '"')
+		close += record[close] == '\\' ? 2 : 1;
+	    return record.substr(start, close - start);
+	}
+	std::size_t close = record.find_first_of(",}\n", start);
+	return record.substr(start, close == std::string_view::npos ? close : close - start);
+    }
+    return {};
+}
+
+bool logger::index::Block::may_contain(std::string_view key, std::string_view value) const {
+    bool all = true;
+    bloom_bits(hash(key, value), bloom.size() * 64, [&](std::uint64_t bit) {
+	all = all && (bloom[bit / 64] >> (bit % 64) & 1);
+    });
+    return all;
+}
+
+namespace {
+/**
+ * @brief Reads the header and keys of an index.
+ */
+bool read_options(std::istream& in, logger::index::IndexOptions& options) {
+    using namespace logger::index;
+    IndexHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof header) ||
+	std::memcmp(header.magic, magic, sizeof magic) != 0 || header.bloom_bits % 64 != 0 ||
+	header.bloom_bits == 0)
+	return false;
+
+    std::string keys(header.keys_size, '\0');
+    if (!in.read(keys.data(), keys.size())) return false;
+    options.block_bytes = header.block_bytes;
+    options.bloom_bits = header.bloom_bits;
+    options.keys.clear();
+    for (std::size_t start = 0, end; (end = keys.find('\n', start)) != std::string::npos;
+	 start = end + 1)
+	options.keys.push_back(keys.substr(start, end - start));
+    return options.keys.size() == header.key_count;
+}
+}  // namespace
+
+bool logger::index::load_options(const std::string& path, IndexOptions& options) {
+    std::ifstream in(path, std::ios::binary);
+    return read_options(in, options);
+}
+
+bool logger::index::Index::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!read_options(in, options)) return false;
+
+    blocks.clear();
+    Block block;
+    block.bloom.resize(options.bloom_bits / 64);
+    // a block cut short by a crash is left out
+    while (in.read(reinterpret_cast<char*>(static_cast<IndexBlock*>(&block)), sizeof(IndexBlock)) &&
+	   in.read(reinterpret_cast<char*>(block.bloom.data()), options.bloom_bits / 8))
+	blocks.push_back(block);
+    return true;
+}
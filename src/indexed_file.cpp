@@ -0,0 +1,94 @@
+#include "ptclogs/sink/indexed_file.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "ptclogs/clock.hpp"
+#include "ptclogs/telemetry.hpp"
+
+namespace {
+void write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+	ssize_t n = write(fd, data, size);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    return;
+	}
+	data += n;
+	size -= n;
+    }
+}
+}  // namespace
+
+logger::IndexedFileBuffer::IndexedFileBuffer(const std::string& path, index::IndexOptions options)
+    : options(options) {
+    this->options.bloom_bits = (options.bloom_bits + 63) / 64 * 64;
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    offset = fd < 0 ? 0 : lseek(fd, 0, SEEK_END);
+    block.offset = offset;
+
+    // a new log file gets a new index. An existing one keeps its index and
+    // the settings it was written with, unless the index can't be read, in
+    // which case it starts over from here.
+    std::string index_path = path + ".idx";
+    bool reuse = offset != 0 && index::load_options(index_path, this->options);
+    index_fd = open(index_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (reuse ? 0 : O_TRUNC),
+		    0644);
+    bloom.resize(this->options.bloom_bits / 64);
+    if (index_fd >= 0 && !reuse) {
+	std::string keys;
+	for (auto& key : this->options.keys) keys += key + '\n';
+	index::IndexHeader header{};
+	std::memcpy(header.magic, index::magic, sizeof header.magic);
+	header.block_bytes = this->options.block_bytes;
+	header.bloom_bits = this->options.bloom_bits;
+	header.key_count = this->options.keys.size();
+	header.keys_size = keys.size();
+	write_all(index_fd, reinterpret_cast<const char*>(&header), sizeof header);
+	write_all(index_fd, keys.data(), keys.size());
+    }
+}
+
+logger::IndexedFileBuffer::~IndexedFileBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    close_block();
+    if (fd >= 0) close(fd);
+    if (index_fd >= 0) close(index_fd);
+}
+
+void logger::IndexedFileBuffer::close_block() {
+    if (block.records == 0) return;
+    std::string entry(reinterpret_cast<const char*>(&block), sizeof block);
+    entry.append(reinterpret_cast<const char*>(bloom.data()), bloom.size() * 8);
+    write_all(index_fd, entry.data(), entry.size());
+    block = index::IndexBlock{offset, 0, 0, 0, 0, 0};
+    std::fill(bloom.begin(), bloom.end(), 0);
+}
+
+void logger::IndexedFileBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::int64_t now = clock::record_time();
+    std::lock_guard<std::mutex> lock(mutex);
+    write_all(fd, data, size);
+    telemetry::flush();
+
+    // replayed records are older than the ones around them, so the span is
+    // kept as a minimum and a maximum rather than the ends of the block
+    if (block.records++ == 0) block.first_ns = block.last_ns = now;
+    block.first_ns = std::min(block.first_ns, now);
+    block.last_ns = std::max(block.last_ns, now);
+    block.levels |= 1u << level;
+    block.size += size;
+    offset += size;
+    std::string_view record(data, size);
+    for (auto& key : options.keys) {
+	std::string_view value = index::find_value(record, key);
+	if (value.empty()) continue;
+	index::bloom_bits(index::hash(key, value), options.bloom_bits,
+			  [this](std::uint64_t bit) { bloom[bit / 64] |= std::uint64_t(1) << (bit % 64); });
+    }
+    if (block.size >= options.block_bytes) close_block();
+}
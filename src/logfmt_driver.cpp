@@ -0,0 +1,44 @@
+#include "ptclogs/driver/logfmt_driver.hpp"
+
+/**
+ * @brief Writes value bare when it is a single token, quoted and escaped
+ * otherwise.
+ *
+ */
+void logger::LogfmtDriver::write_string(std::string_view value) {
+    bool bare = !value.empty();
+    for (unsigned char c : value) {
+	if (c <= ' ' || c == '=' || c == '"' || c == '\\' || c == ',' || c == ']' ||
+	    c == '}') {
+	    bare = false;
+	    break;
+	}
+    }
+    if (bare) {
+	out << value;
+	return;
+    }
+    out << '"';
+    for (char c : value) {
+	switch (c) {
+	    case '"':
+		out << "\\\"";
+		break;
+	    case '\\':
+		out << "\\\\";
+		break;
+	    case '\n':
+		out << "\\n";
+		break;
+	    case '\r':
+		out << "\\r";
+		break;
+	    case '\t':
+		out << "\\t";
+		break;
+	    default:
+		out << c;
+	}
+    }
+    out << '"';
+}
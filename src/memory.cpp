@@ -0,0 +1,93 @@
+#include "ptclogs/memory.hpp"
+
+#include <atomic>
+
+namespace {
+std::atomic<std::uint64_t> in_use{0};
+std::atomic<std::uint64_t> high_water{0};
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> arena_in_use{0};
+std::atomic<std::uint64_t> arena_high_water{0};
+std::atomic<std::int64_t> pooled_bytes{0};
+
+void raise(std::atomic<std::uint64_t>& mark, std::uint64_t value) {
+    std::uint64_t seen = mark.load(std::memory_order_relaxed);
+    while (value > seen && !mark.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Counts what goes through an upstream resource.
+ */
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+  private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+	void* p = upstream->allocate(bytes, align);
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	raise(high_water, in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+	in_use.fetch_sub(bytes, std::memory_order_relaxed);
+	upstream->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+	return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream;
+};
+
+std::pmr::memory_resource* default_resource() {
+    // leaked, memory may be returned to it while statics are destroyed
+    static CountingResource* r = new CountingResource(
+	new std::pmr::synchronized_pool_resource(std::pmr::new_delete_resource()));
+    return r;
+}
+
+std::atomic<std::pmr::memory_resource*> current{nullptr};
+}  // namespace
+
+std::pmr::memory_resource* logger::memory::resource() {
+    std::pmr::memory_resource* r = current.load(std::memory_order_acquire);
+    return r ? r : default_resource();
+}
+
+void logger::memory::set_resource(std::pmr::memory_resource* upstream) {
+    // wrappers are leaked too, memory allocated through them may still be out
+    current.store(upstream ? new CountingResource(upstream) : nullptr, std::memory_order_release);
+}
+
+logger::memory::Usage logger::memory::usage() {
+    Usage u;
+    u.in_use = in_use.load(std::memory_order_relaxed);
+    u.high_water = high_water.load(std::memory_order_relaxed);
+    u.allocations = allocations.load(std::memory_order_relaxed);
+    u.arena_in_use = arena_in_use.load(std::memory_order_relaxed);
+    u.arena_high_water = arena_high_water.load(std::memory_order_relaxed);
+    std::int64_t pooled = pooled_bytes.load(std::memory_order_relaxed);
+    u.pooled = pooled > 0 ? pooled : 0;
+    return u;
+}
+
+void logger::memory::reset_high_water() {
+    high_water.store(in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    arena_high_water.store(arena_in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void logger::memory::arena_acquired(std::size_t bytes) {
+    raise(arena_high_water, arena_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void logger::memory::arena_released(std::size_t bytes) {
+    arena_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void logger::memory::pooled(std::int64_t bytes) {
+    pooled_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
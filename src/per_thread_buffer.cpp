@@ -0,0 +1,235 @@
+#include "ptclogs/sink/per_thread_buffer.hpp"
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <queue>
+#include <string>
+
+#include "ptclogs/telemetry.hpp"
+
+namespace {
+/**
+ * @brief Header written in front of every record in a ring. Records and
+ * headers are 16 byte aligned, so a gap at the end of the ring always has
+ * room for a skip header.
+ */
+struct Header {
+    std::uint64_t stamp;
+    std::uint32_t size;
+    std::uint32_t level;
+};
+constexpr std::uint32_t skip = UINT32_MAX;
+constexpr std::size_t align(std::size_t n) { return (n + 15) & ~std::size_t(15); }
+
+std::uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	       std::chrono::steady_clock::now().time_since_epoch())
+	.count();
+}
+
+std::atomic<std::uint64_t> next_id{1};
+}  // namespace
+
+/**
+ * @brief Single producer, single consumer byte ring owned by one thread.
+ *
+ */
+struct logger::PerThreadBuffer::Ring {
+    Ring(std::size_t size) : data(new char[size]), size(size) {}
+    std::unique_ptr<char[]> data;
+    std::size_t size;
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+    std::atomic<bool> closed{false};
+};
+
+logger::PerThreadBuffer::PerThreadBuffer(int fd, std::chrono::microseconds window,
+					 std::size_t ring_size)
+    : fd(fd), window(window), ring_size(64), id(next_id++) {
+    while (this->ring_size < ring_size) this->ring_size <<= 1;
+    collector = std::thread(&PerThreadBuffer::run, this);
+}
+
+logger::PerThreadBuffer::~PerThreadBuffer() {
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+    }
+    wake.notify_one();
+    collector.join();
+}
+
+/**
+ * @brief Returns the ring of the calling thread, creating it on first use.
+ *
+ */
+logger::PerThreadBuffer::Ring& logger::PerThreadBuffer::local() {
+    // closes the rings of this thread when it exits, so the collector can drop
+    // them. The buffer owns the rings, slots of destroyed buffers expire.
+    struct Slot {
+	std::uint64_t id;
+	Ring* ring;
+	std::weak_ptr<Ring> owner;
+    };
+    struct Slots {
+	std::vector<Slot> list;
+	~Slots() {
+	    for (auto& slot : list)
+		if (auto ring = slot.owner.lock()) ring->closed.store(true, std::memory_order_release);
+	}
+    };
+    static thread_local Slots slots;
+    for (auto& slot : slots.list)
+	if (slot.id == id) return *slot.ring;
+
+    std::erase_if(slots.list, [](const Slot& slot) { return slot.owner.expired(); });
+    auto ring = std::make_shared<Ring>(ring_size);
+    {
+	std::lock_guard<std::mutex> lock(rings_mutex);
+	rings.push_back(ring);
+    }
+    slots.list.push_back(Slot{id, ring.get(), ring});
+    return *ring;
+}
+
+void logger::PerThreadBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::size_t need = align(sizeof(Header) + size);
+    if (need > ring_size / 2) {
+	// too large for the rings, it skips the ordering
+	write_all(data, size);
+	return;
+    }
+
+    Ring& ring = local();
+    std::uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    std::size_t offset = tail & (ring_size - 1);
+    std::size_t gap = offset + need > ring_size ? ring_size - offset : 0;
+    for (int spins = 0; ring_size - (tail - ring.head.load(std::memory_order_acquire)) < gap + need;
+	 spins++) {
+	// the ring is full, have the collector drain it without waiting for the window
+	pressure.store(true, std::memory_order_relaxed);
+	wake.notify_one();
+	if (spins < 16)
+	    std::this_thread::yield();
+	else
+	    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    if (gap) {
+	Header h{0, skip, 0};
+	std::memcpy(ring.data.get() + offset, &h, sizeof h);
+	offset = 0;
+    }
+    Header h{now_ns(), std::uint32_t(size), std::uint32_t(level)};
+    std::memcpy(ring.data.get() + offset, &h, sizeof h);
+    std::memcpy(ring.data.get() + offset + sizeof h, data, size);
+    ring.tail.store(tail + gap + need, std::memory_order_release);
+}
+
+void logger::PerThreadBuffer::write_all(const char* data, std::size_t size) {
+    // direct writes and the collector's batches go out whole, one at a time
+    std::lock_guard<std::mutex> lock(write_mutex);
+    while (size > 0) {
+	ssize_t n = write(fd, data, size);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+		pollfd p{fd, POLLOUT, 0};
+		poll(&p, 1, -1);
+		continue;
+	    }
+	    return;
+	}
+	data += n;
+	size -= n;
+    }
+    telemetry::flush();
+}
+
+/**
+ * @brief Merges and writes out every record stamped at or before horizon.
+ *
+ * @return Whether anything was written.
+ */
+bool logger::PerThreadBuffer::collect(std::uint64_t horizon) {
+    struct Cursor {
+	Ring* ring;
+	std::uint64_t pos;
+	std::uint64_t tail;
+	const Header* header;
+    };
+    std::vector<std::shared_ptr<Ring>> current;
+    {
+	std::lock_guard<std::mutex> lock(rings_mutex);
+	current = rings;
+    }
+
+    // positions a cursor on its next record, skipping the wrap markers
+    auto next = [this](Cursor& c) {
+	while (c.pos < c.tail) {
+	    std::size_t offset = c.pos & (ring_size - 1);
+	    c.header = reinterpret_cast<const Header*>(c.ring->data.get() + offset);
+	    if (c.header->size != skip) return true;
+	    c.pos += ring_size - offset;
+	}
+	c.header = nullptr;
+	return false;
+    };
+    std::vector<Cursor> cursors;
+    for (auto& ring : current) {
+	Cursor c{ring.get(), ring->head.load(std::memory_order_relaxed),
+		 ring->tail.load(std::memory_order_acquire), nullptr};
+	next(c);
+	cursors.push_back(c);
+    }
+
+    auto later = [&cursors](std::size_t a, std::size_t b) {
+	return cursors[a].header->stamp > cursors[b].header->stamp;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+    for (std::size_t i = 0; i < cursors.size(); i++)
+	if (cursors[i].header && cursors[i].header->stamp <= horizon) heap.push(i);
+
+    std::string batch;
+    while (!heap.empty()) {
+	Cursor& c = cursors[heap.top()];
+	std::size_t i = heap.top();
+	heap.pop();
+	batch.append(reinterpret_cast<const char*>(c.header + 1), c.header->size);
+	c.pos += align(sizeof(Header) + c.header->size);
+	if (next(c) && c.header->stamp <= horizon) heap.push(i);
+    }
+    if (!batch.empty()) write_all(batch.data(), batch.size());
+    for (auto& c : cursors) c.ring->head.store(c.pos, std::memory_order_release);
+
+    // drop the rings of threads that exited once they are drained
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (auto it = rings.begin(); it != rings.end();) {
+	Ring& r = **it;
+	if (r.closed.load(std::memory_order_acquire) &&
+	    r.head.load(std::memory_order_relaxed) == r.tail.load(std::memory_order_acquire))
+	    it = rings.erase(it);
+	else
+	    ++it;
+    }
+    return !batch.empty();
+}
+
+void logger::PerThreadBuffer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!done) {
+	wake.wait_for(lock, window / 2 + std::chrono::microseconds(1));
+	lock.unlock();
+	std::uint64_t horizon = now_ns();
+	if (!pressure.exchange(false, std::memory_order_relaxed))
+	    horizon -= std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+	collect(horizon);
+	lock.lock();
+    }
+    lock.unlock();
+    while (collect(UINT64_MAX)) {
+    }
+}
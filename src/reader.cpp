@@ -0,0 +1,339 @@
+#include "ptclogs/reader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+using logger::reader::Field;
+using logger::reader::Format;
+using logger::reader::Record;
+
+/**
+ * @brief Returns the position after the string starting at pos.
+ */
+std::size_t skip_string(std::string_view text, std::size_t pos) {
+    for (pos++; pos < text.size(); pos++) {
+	if (text[pos] == '\\')
+	    pos++;
+	else if (text[pos] == '"')
+	    return pos + 1;
+    }
+    return text.size();
+}
+
+/**
+ * @brief Returns the position after the JSON value starting at pos.
+ */
+std::size_t skip_value(std::string_view text, std::size_t pos) {
+    if (pos >= text.size()) return pos;
+    if (text[pos] == '"') return skip_string(text, pos);
+    if (text[pos] != '{' && text[pos] != '[') {
+	std::size_t end = text.find_first_of(",}]", pos);
+	return end == std::string_view::npos ? text.size() : end;
+    }
+    int depth = 0;
+    while (pos < text.size()) {
+	char c = text[pos];
+	if (c == '"') {
+	    pos = skip_string(text, pos);
+	    continue;
+	}
+	if (c == '{' || c == '[') depth++;
+	if ((c == '}' || c == ']') && --depth == 0) return pos + 1;
+	pos++;
+    }
+    return pos;
+}
+
+/**
+ * @brief Returns the value in [start, end), without the quotes of a string.
+ */
+std::string_view value_view(std::string_view text, std::size_t start, std::size_t end) {
+    if (end - start >= 2 && text[start] == '"') return text.substr(start + 1, end - start - 2);
+    return text.substr(start, end - start);
+}
+
+bool next_json_field(std::string_view& text, Field& field) {
+    std::size_t pos = text.find_first_not_of(", ");
+    if (pos == std::string_view::npos || text[pos] != '"') return false;
+    std::size_t key_end = skip_string(text, pos);
+    if (key_end >= text.size() || text[key_end] != ':') return false;
+    field.key = text.substr(pos + 1, key_end - pos - 2);
+    std::size_t end = skip_value(text, key_end + 1);
+    field.quoted = text[key_end + 1] == '"';
+    field.value = value_view(text, key_end + 1, end);
+    text.remove_prefix(end);
+    return true;
+}
+
+bool next_console_field(std::string_view& text, Field& field) {
+    if (text.empty()) return false;
+    std::size_t colon = text.find(": ");
+    if (colon == std::string_view::npos) return false;
+    std::size_t end = text.find(", ", colon + 2);
+    field.key = text.substr(0, colon);
+    field.value = text.substr(colon + 2, end == std::string_view::npos ? end : end - colon - 2);
+    field.quoted = false;
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 2);
+    return true;
+}
+
+/**
+ * @brief Parses the sections in the order the drivers write them.
+ */
+bool parse_json_prefix(std::string_view line, Record& record) {
+    constexpr std::string_view ts = "{\"ts\":\"", level = "\",\"level\":\"", msg = "\",\"msg\":";
+    if (!line.starts_with(ts)) return false;
+    std::size_t ts_end = line.find('"', ts.size());
+    if (ts_end == std::string_view::npos || line.compare(ts_end, level.size(), level) != 0)
+	return false;
+    std::size_t level_start = ts_end + level.size();
+    std::size_t level_end = line.find('"', level_start);
+    if (level_end == std::string_view::npos || line.compare(level_end, msg.size(), msg) != 0)
+	return false;
+    std::size_t msg_start = level_end + msg.size();
+    std::size_t msg_end = skip_value(line, msg_start);
+
+    record.ts = line.substr(ts.size(), ts_end - ts.size());
+    record.level = line.substr(level_start, level_end - level_start);
+    record.msg = value_view(line, msg_start, msg_end);
+    std::size_t close = line.find_last_of('}');
+    record.fields = close > msg_end ? line.substr(msg_end, close - msg_end) : std::string_view();
+    return true;
+}
+
+bool parse_json(std::string_view line, Record& record) {
+    if (parse_json_prefix(line, record)) return true;
+    std::size_t open = line.find_first_not_of(' ');
+    std::size_t close = line.find_last_of('}');
+    if (open == std::string_view::npos || line[open] != '{' || close == std::string_view::npos)
+	return false;
+    record.fields = line.substr(open + 1, close - open - 1);
+    record.ts = record.level = record.msg = {};
+    std::string_view rest = record.fields;
+    Field field;
+    while (next_json_field(rest, field)) {
+	if (field.key == "ts")
+	    record.ts = field.value;
+	else if (field.key == "level")
+	    record.level = field.value;
+	else if (field.key == "msg")
+	    record.msg = field.value;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the text between the color escape codes of a level.
+ */
+std::string_view strip_color(std::string_view text) {
+    if (text.starts_with("\e[")) {
+	std::size_t m = text.find('m');
+	if (m != std::string_view::npos) text.remove_prefix(m + 1);
+    }
+    std::size_t reset = text.find("\e[");
+    return text.substr(0, reset);
+}
+
+bool parse_console(std::string_view line, Record& record) {
+    std::size_t ts_end = line.find('\t');
+    if (ts_end == std::string_view::npos) return false;
+    std::size_t level_end = line.find('\t', ts_end + 1);
+    if (level_end == std::string_view::npos) return false;
+    std::size_t msg_end = line.find('\t', level_end + 1);
+
+    record.ts = line.substr(0, ts_end);
+    record.level = strip_color(line.substr(ts_end + 1, level_end - ts_end - 1));
+    if (msg_end == std::string_view::npos) {
+	record.msg = line.substr(level_end + 1);
+	record.fields = {};
+    } else {
+	record.msg = line.substr(level_end + 1, msg_end - level_end - 1);
+	record.fields = line.substr(msg_end + 1);
+    }
+    return true;
+}
+
+bool hex4(std::string_view text, unsigned& value) {
+    if (text.size() < 4) return false;
+    value = 0;
+    for (char c : text.substr(0, 4)) {
+	int digit = c >= '0' && c <= '9'   ? c - '0'
+		    : c >= 'a' && c <= 'f' ? c - 'a' + 10
+		    : c >= 'A' && c <= 'F' ? c - 'A' + 10
+					   : -1;
+	if (digit < 0) return false;
+	value = value << 4 | digit;
+    }
+    return true;
+}
+
+void append_utf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+	out += char(cp);
+    } else if (cp < 0x800) {
+	out += char(0xc0 | cp >> 6);
+	out += char(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+	out += char(0xe0 | cp >> 12);
+	out += char(0x80 | (cp >> 6 & 0x3f));
+	out += char(0x80 | (cp & 0x3f));
+    } else {
+	out += char(0xf0 | cp >> 18);
+	out += char(0x80 | (cp >> 12 & 0x3f));
+	out += char(0x80 | (cp >> 6 & 0x3f));
+	out += char(0x80 | (cp & 0x3f));
+    }
+}
+}  // namespace
+
+const char* logger::reader::find_newline(const char* begin, const char* end) {
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - begin >= 16) {
+	__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+	int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+	if (mask) return begin + __builtin_ctz(mask);
+	begin += 16;
+    }
+#endif
+    const void* nl = std::memchr(begin, '\n', end - begin);
+    return nl ? static_cast<const char*>(nl) : end;
+}
+
+bool logger::reader::parse(std::string_view line, Format format, Record& record) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    record.line = line;
+    record.format = format;
+    return format == Format::JSON ? parse_json(line, record) : parse_console(line, record);
+}
+
+std::string_view logger::reader::timestamp(std::string_view line, Format format) {
+    if (format == Format::CONSOLE) return line.substr(0, line.find('\t'));
+    constexpr std::string_view ts = "{\"ts\":\"";
+    if (line.starts_with(ts)) {
+	std::size_t end = line.find('"', ts.size());
+	if (end != std::string_view::npos) return line.substr(ts.size(), end - ts.size());
+    }
+    Record record;
+    return parse(line, format, record) ? record.ts : std::string_view();
+}
+
+bool logger::reader::next_field(std::string_view& text, Format format, Field& field) {
+    return format == Format::JSON ? next_json_field(text, field) : next_console_field(text, field);
+}
+
+std::string_view logger::reader::Record::get(std::string_view key) const {
+    std::string_view rest = fields;
+    Field field;
+    while (next_field(rest, format, field))
+	if (field.key == key) return field.value;
+    return {};
+}
+
+std::string logger::reader::unescape(std::string_view value) {
+    std::string out;
+    out.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); i++) {
+	if (value[i] != '\\' || i + 1 == value.size()) {
+	    out += value[i];
+	    continue;
+	}
+	char c = value[++i];
+	switch (c) {
+	    case 'n':
+		out += '\n';
+		break;
+	    case 'r':
+		out += '\r';
+		break;
+	    case 't':
+		out += '\t';
+		break;
+	    case 'b':
+		out += '\b';
+		break;
+	    case 'f':
+		out += '\f';
+		break;
+	    case 'u': {
+		unsigned cp, low;
+		if (!hex4(value.substr(i + 1), cp)) return out;
+		i += 4;
+		// a surrogate pair is two escapes
+		if (cp >= 0xd800 && cp < 0xdc00 && value.substr(i + 1, 2) == "\\u" &&
+		    hex4(value.substr(i + 3), low)) {
+		    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+		    i += 6;
+		}
+		append_utf8(out, cp);
+		break;
+	    }
+	    default:
+		out += c;
+	}
+    }
+    return out;
+}
+
+logger::reader::Format logger::reader::detect(std::string_view data) {
+    std::size_t start = data.find_first_not_of(" \n");
+    return start != std::string_view::npos && data[start] == '{' ? Format::JSON
+								   : Format::CONSOLE;
+}
+
+std::vector<std::string_view> logger::reader::split(std::string_view data, std::size_t parts) {
+    std::vector<std::string_view> ranges;
+    const char* end = data.data() + data.size();
+    const char* start = data.data();
+    for (std::size_t i = 1; i <= parts && start < end; i++) {
+	const char* cut = end;
+	if (i < parts) {
+	    cut = std::max(start, data.data() + data.size() / parts * i);
+	    const char* nl = find_newline(cut, end);
+	    cut = nl == end ? end : nl + 1;
+	}
+	ranges.emplace_back(start, cut - start);
+	start = cut;
+    }
+    return ranges;
+}
+
+logger::reader::MappedFile::~MappedFile() {
+    if (begin) munmap(const_cast<char*>(begin), size);
+}
+
+bool logger::reader::MappedFile::open(const std::string& path) {
+    if (begin) munmap(const_cast<char*>(begin), size);
+    begin = nullptr;
+    size = 0;
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+	close(fd);
+	return false;
+    }
+    if (st.st_size > 0) {
+	void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+	    close(fd);
+	    return false;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+	begin = static_cast<const char*>(map);
+	size = st.st_size;
+    }
+    close(fd);
+    return true;
+}
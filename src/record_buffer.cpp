@@ -0,0 +1,80 @@
+#include "ptclogs/sink/record_buffer.hpp"
+
+#include <deque>
+#include <string>
+
+#include "ptclogs/telemetry.hpp"
+
+namespace {
+/**
+ * @brief Bytes a thread has written to one buffer and not flushed yet.
+ */
+struct Staging {
+    const logger::RecordBuffer* owner;
+    std::string bytes;
+};
+
+/**
+ * @brief Returns the bytes of the record this thread is currently writing to
+ * owner.
+ *
+ * Each buffer has its own, so a record logged to another logger while this
+ * one is being formatted, from operator<< or a Lazy value, doesn't end up in
+ * the middle of it. Entries left empty are reused, so a thread keeps as many
+ * as it ever had records in progress at once.
+ */
+std::string& staging(const logger::RecordBuffer* owner) {
+    // a deque keeps the bytes in place while more are added
+    static thread_local std::deque<Staging> stagings;
+    static thread_local Staging* last = nullptr;
+    if (last && last->owner == owner) return last->bytes;
+    Staging* reusable = nullptr;
+    for (auto& s : stagings) {
+	if (s.owner == owner) {
+	    last = &s;
+	    return s.bytes;
+	}
+	if (!reusable && s.bytes.empty()) reusable = &s;
+    }
+    if (!reusable) reusable = &stagings.emplace_back();
+    reusable->owner = owner;
+    last = reusable;
+    return reusable->bytes;
+}
+}  // namespace
+
+logger::RecordBuffer::int_type logger::RecordBuffer::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    staging(this).push_back(traits_type::to_char_type(c));
+    return c;
+}
+
+std::streamsize logger::RecordBuffer::xsputn(const char* s, std::streamsize n) {
+    staging(this).append(s, n);
+    return n;
+}
+
+int logger::RecordBuffer::sync() {
+    std::string& buf = staging(this);
+    if (buf.empty()) return 0;
+    if (batch_size) {
+	for (std::size_t i = 0; i < batch_size; i++)
+	    telemetry::bytes(batch_records[i].level,
+			     batch_records[i].end - (i ? batch_records[i - 1].end : 0));
+	commit_batch(buf.data(), batch_records, batch_size);
+    } else {
+	telemetry::bytes(record_level, buf.size());
+	commit(record_level, buf.data(), buf.size());
+    }
+    buf.clear();
+    return 0;
+}
+
+void logger::RecordBuffer::commit_batch(const char* data, const BatchRecord* records,
+					std::size_t count) {
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < count; i++) {
+	commit(records[i].level, data + start, records[i].end - start);
+	start = records[i].end;
+    }
+}
@@ -0,0 +1,96 @@
+#include <utility>
+
+#include "ptclogs/sink/overflow.hpp"
+#include "ptclogs/telemetry.hpp"
+
+bool logger::RecordQueue::fits(std::size_t size) const {
+    // an oversized record still goes through once the queue is empty
+    return records.empty() || bytes + size <= policy.capacity;
+}
+
+/**
+ * @brief Evicts the oldest pending record whose level is more verbose than
+ * level.
+ *
+ */
+bool logger::RecordQueue::evict_above(int level) {
+    // the head may be partially written already, so it is never evicted
+    for (auto it = records.begin() + (records.empty() ? 0 : 1); it != records.end(); ++it) {
+	if (it->level > level) {
+	    bytes -= it->data.size();
+	    dropped[it->level]++;
+	    telemetry::drop(it->level);
+	    records.erase(it);
+	    return true;
+	}
+    }
+    return false;
+}
+
+logger::RecordQueue::Admission logger::RecordQueue::admit(LogLevel level, std::size_t size,
+							  bool expired) {
+    switch (policy.mode) {
+	case OverflowMode::BLOCK:
+	    return fits(size) ? ADMIT : WAIT;
+	case OverflowMode::BLOCK_TIMEOUT:
+	    if (fits(size)) return ADMIT;
+	    return expired ? DROP : WAIT;
+	case OverflowMode::DROP_NEWEST:
+	    return fits(size) ? ADMIT : DROP;
+	case OverflowMode::DROP_OLDEST:
+	    while (!fits(size) && evict_above(-1)) {
+	    }
+	    return fits(size) ? ADMIT : DROP;
+	case OverflowMode::SHED_BY_LEVEL: {
+	    // the fill before the record, so a single large one isn't shed from
+	    // an empty queue
+	    double fill = double(bytes) / policy.capacity;
+	    if (level == LogLevel::DEBUG && fill > policy.shed_debug_at) return DROP;
+	    if (level == LogLevel::INFO && fill > policy.shed_info_at) return DROP;
+	    // make room by shedding the most verbose records first
+	    for (int shed = LogLevel::DEBUG; shed > level && shed > LogLevel::ERROR; shed--) {
+		while (!fits(size) && evict_above(shed - 1)) {
+		}
+	    }
+	    if (fits(size)) return ADMIT;
+	    return level <= LogLevel::ERROR ? WAIT : DROP;
+	}
+    }
+    return ADMIT;
+}
+
+void logger::RecordQueue::push(LogLevel level, const char* data, std::size_t size) {
+    records.push_back(Record{level, std::pmr::string(data, size, records.get_allocator())});
+    bytes += size;
+    telemetry::queue_depth(bytes);
+}
+
+void logger::RecordQueue::drop(LogLevel level) {
+    dropped[level]++;
+    telemetry::drop(level);
+}
+
+void logger::RecordQueue::consume(std::size_t n) {
+    records.front().data.erase(0, n);
+    bytes -= n;
+}
+
+void logger::RecordQueue::pop() {
+    bytes -= records.front().data.size();
+    records.pop_front();
+}
+
+void logger::RecordQueue::take(std::pmr::deque<Record>& out) {
+    out = std::move(records);
+    records.clear();
+    bytes = 0;
+}
+
+bool logger::RecordQueue::take_drops(DropCounts& counts) {
+    bool any = false;
+    for (auto c : dropped) any |= c != 0;
+    if (!any) return false;
+    counts = dropped;
+    dropped.fill(0);
+    return true;
+}
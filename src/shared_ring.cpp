@@ -0,0 +1,463 @@
+#include "ptclogs/sink/shared_ring.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "ptclogs/telemetry.hpp"
+
+/**
+ * @brief Start of the shared segment. Lanes follow it, then the lane data.
+ */
+struct logger::SharedRingBuffer::Control {
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t lanes;
+    std::uint64_t lane_size;
+    std::atomic<bool> pressure;
+    /**
+     * @brief Records dropped by any process since the last drop report.
+     */
+    std::atomic<std::uint64_t> dropped[5];
+};
+
+/**
+ * @brief Single producer ring claimed by one thread of one process. The owner
+ * is the pid of that process, 0 when the lane is free, and started its start
+ * time, which tells it apart from a later process reusing the pid. started
+ * is 0 while the lane is being claimed.
+ */
+struct logger::SharedRingBuffer::Lane {
+    alignas(64) std::atomic<std::int32_t> owner;
+    std::atomic<std::uint32_t> closed;
+    std::atomic<std::uint64_t> started;
+    alignas(64) std::atomic<std::uint64_t> head;
+    alignas(64) std::atomic<std::uint64_t> tail;
+};
+
+/**
+ * @brief Draining thread, kept out of the object so a forked child can leave
+ * the parent's copy alone: the condition variable may still list the
+ * parent's thread as a waiter.
+ */
+struct logger::SharedRingBuffer::Drainer {
+    int fd;
+    std::chrono::microseconds window;
+    int pid = getpid();
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    std::uint64_t verified_at = 0;
+    std::thread thread;
+};
+
+namespace {
+using logger::SharedRingBuffer;
+
+constexpr std::uint32_t magic = 0x50544352;  // PTCR
+
+/**
+ * @brief Header written in front of every record in a lane, as in
+ * PerThreadBuffer.
+ */
+struct Header {
+    std::uint64_t stamp;
+    std::uint32_t size;
+    std::uint32_t level;
+};
+constexpr std::uint32_t skip = UINT32_MAX;
+constexpr std::size_t align(std::size_t n, std::size_t to = 16) { return (n + to - 1) & ~(to - 1); }
+
+std::uint64_t now_ns() {
+    // CLOCK_MONOTONIC is the same clock in every process
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	       std::chrono::steady_clock::now().time_since_epoch())
+	.count();
+}
+
+constexpr std::size_t lanes_offset = align(sizeof(SharedRingBuffer::Control), 64);
+
+std::size_t data_offset(std::size_t lanes) {
+    return align(lanes_offset + lanes * sizeof(SharedRingBuffer::Lane), 4096);
+}
+
+std::size_t round_lane_size(std::size_t lane_size) {
+    std::size_t size = 4096;
+    while (size < lane_size) size <<= 1;
+    return size;
+}
+
+/**
+ * @brief Returns the start time of a process in clock ticks since boot, field
+ * 22 of /proc/PID/stat, or 0 if there is no such process.
+ */
+std::uint64_t start_time(std::int32_t pid) {
+    char path[32], stat[1024];
+    snprintf(path, sizeof path, "/proc/%d/stat", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, stat, sizeof stat - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    stat[n] = '\0';
+    // the command name may hold spaces and parentheses, fields start after the last ')'
+    const char* field = strrchr(stat, ')');
+    for (int i = 2; field && i < 22; i++) field = strchr(field + 1, ' ');
+    return field ? strtoull(field + 1, nullptr, 10) : 0;
+}
+
+/**
+ * @brief Returns the start time of the calling process, read again after a
+ * fork.
+ */
+std::uint64_t own_start_time() {
+    static std::atomic<std::int32_t> pid{0};
+    static std::atomic<std::uint64_t> started{0};
+    std::int32_t self = getpid();
+    if (pid.load(std::memory_order_acquire) != self) {
+	started.store(start_time(self), std::memory_order_relaxed);
+	pid.store(self, std::memory_order_release);
+    }
+    return started.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns whether the process that claimed a lane still runs. A pid
+ * alone could have been reused by an unrelated process since, which only
+ * reading its start time tells, so that is done when verify is set.
+ */
+bool alive(std::int32_t pid, std::uint64_t started, bool verify) {
+    if (kill(pid, 0) != 0 && errno == ESRCH) return false;
+    // still being claimed
+    if (started == 0 || !verify) return true;
+    return start_time(pid) == started;
+}
+
+void write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+	ssize_t n = write(fd, data, size);
+	if (n < 0) {
+	    if (errno == EINTR) continue;
+	    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+		pollfd p{fd, POLLOUT, 0};
+		poll(&p, 1, -1);
+		continue;
+	    }
+	    return;
+	}
+	data += n;
+	size -= n;
+    }
+}
+
+std::atomic<std::uint64_t> next_id{1};
+
+/**
+ * @brief Ids of the rings mapped in this process, so exiting threads don't
+ * touch the lanes of a ring that was destroyed before them.
+ */
+struct Live {
+    std::mutex mutex;
+    std::vector<std::uint64_t> ids;
+};
+
+Live& live() {
+    static Live* l = new Live();  // outlives thread_local destructors
+    return *l;
+}
+
+void set_live(std::uint64_t id, bool mapped) {
+    Live& l = live();
+    std::lock_guard<std::mutex> lock(l.mutex);
+    if (mapped)
+	l.ids.push_back(id);
+    else
+	l.ids.erase(std::remove(l.ids.begin(), l.ids.end(), id), l.ids.end());
+}
+}  // namespace
+
+logger::SharedRingBuffer::SharedRingBuffer(std::size_t lanes, std::size_t lane_size,
+					   DropReporter reporter)
+    : id(next_id++), reporter(reporter) {
+    lane_size = round_lane_size(lane_size);
+    map(-1, data_offset(lanes) + lanes * lane_size, true, lanes, lane_size);
+}
+
+logger::SharedRingBuffer::SharedRingBuffer(const std::string& name, std::size_t lanes,
+					   std::size_t lane_size, DropReporter reporter)
+    : name(name), id(next_id++), reporter(reporter) {
+    lane_size = round_lane_size(lane_size);
+    int shm = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (shm >= 0) {
+	creator = true;
+	std::size_t size = data_offset(lanes) + lanes * lane_size;
+	if (ftruncate(shm, size) == 0) map(shm, size, true, lanes, lane_size);
+	close(shm);
+	return;
+    }
+    shm = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0600);
+    if (shm < 0) return;
+    // the creator may still be setting the segment up
+    void* first = mmap(nullptr, sizeof(Control), PROT_READ, MAP_SHARED, shm, 0);
+    if (first == MAP_FAILED) {
+	close(shm);
+	return;
+    }
+    const Control* header = static_cast<const Control*>(first);
+    for (int tries = 0; tries < 1000 && header->magic.load(std::memory_order_acquire) != magic;
+	 tries++)
+	usleep(1000);
+    if (header->magic.load(std::memory_order_acquire) == magic)
+	map(shm, data_offset(header->lanes) + header->lanes * header->lane_size, false, 0, 0);
+    munmap(first, sizeof(Control));
+    close(shm);
+}
+
+void logger::SharedRingBuffer::map(int shm, std::size_t size, bool init, std::size_t lanes,
+				   std::size_t lane_size) {
+    int flags = shm < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, shm, 0);
+    if (base == MAP_FAILED) return;
+    mapped = size;
+    control = static_cast<Control*>(base);
+    set_live(id, true);
+    if (!init) return;
+
+    // fresh mappings are zeroed, which is a free lane
+    control->lanes = lanes;
+    control->lane_size = lane_size;
+    control->magic.store(magic, std::memory_order_release);
+}
+
+logger::SharedRingBuffer::~SharedRingBuffer() {
+    if (drainer && drainer->pid == getpid()) {
+	{
+	    std::lock_guard<std::mutex> lock(drainer->mutex);
+	    drainer->done = true;
+	}
+	drainer->wake.notify_one();
+	drainer->thread.join();
+    } else {
+	// a forked copy of the draining process doesn't have the drainer thread
+	drainer.release();
+    }
+    if (control) {
+	set_live(id, false);
+	munmap(control, mapped);
+    }
+    if (creator) shm_unlink(name.c_str());
+}
+
+logger::SharedRingBuffer::Lane* logger::SharedRingBuffer::lanes() {
+    return reinterpret_cast<Lane*>(reinterpret_cast<char*>(control) + lanes_offset);
+}
+
+char* logger::SharedRingBuffer::lane_data(std::size_t index) {
+    return reinterpret_cast<char*>(control) + data_offset(control->lanes) +
+	   index * control->lane_size;
+}
+
+/**
+ * @brief Returns the lane of the calling thread, claiming a free one on first
+ * use. Threads of a forked child claim their own lanes.
+ */
+std::size_t logger::SharedRingBuffer::local() {
+    struct Claim {
+	std::uint64_t owner;
+	std::int32_t pid;
+	Lane* lane;
+	std::size_t index;
+    };
+    // frees the lanes of this thread when it exits, once they are drained
+    struct Claims {
+	std::vector<Claim> list;
+	~Claims() {
+	    Live& l = live();
+	    std::lock_guard<std::mutex> lock(l.mutex);
+	    for (auto& claim : list)
+		if (claim.pid == getpid() &&
+		    std::find(l.ids.begin(), l.ids.end(), claim.owner) != l.ids.end())
+		    claim.lane->closed.store(1, std::memory_order_release);
+	}
+    };
+    static thread_local Claims claims;
+    std::int32_t pid = getpid();
+    for (auto& claim : claims.list)
+	if (claim.owner == id && claim.pid == pid) return claim.index;
+
+    while (true) {
+	for (std::size_t i = 0; i < control->lanes; i++) {
+	    std::int32_t free = 0;
+	    if (lanes()[i].owner.compare_exchange_strong(free, pid, std::memory_order_acquire)) {
+		lanes()[i].started.store(own_start_time(), std::memory_order_release);
+		claims.list.push_back(Claim{id, pid, &lanes()[i], i});
+		return i;
+	    }
+	}
+	// every lane is taken, wait for the drainer to free one
+	std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+void logger::SharedRingBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    if (!control) return;
+    std::size_t lane_size = control->lane_size;
+    std::size_t need = align(sizeof(Header) + size);
+    if (need > lane_size / 2) {
+	// counted in the segment, the drainer reports it
+	control->dropped[level].fetch_add(1, std::memory_order_relaxed);
+	telemetry::drop(level);
+	return;
+    }
+
+    std::size_t index = local();
+    Lane* lane = &lanes()[index];
+    char* ring = lane_data(index);
+    std::uint64_t tail = lane->tail.load(std::memory_order_relaxed);
+    std::size_t offset = tail & (lane_size - 1);
+    std::size_t gap = offset + need > lane_size ? lane_size - offset : 0;
+    for (int spins = 0; lane_size - (tail - lane->head.load(std::memory_order_acquire)) < gap + need;
+	 spins++) {
+	// the lane is full, the drainer polls this to drain without waiting for the window
+	control->pressure.store(true, std::memory_order_relaxed);
+	if (spins < 16)
+	    std::this_thread::yield();
+	else
+	    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    if (gap) {
+	Header h{0, skip, 0};
+	std::memcpy(ring + offset, &h, sizeof h);
+	offset = 0;
+    }
+    Header h{now_ns(), std::uint32_t(size), std::uint32_t(level)};
+    std::memcpy(ring + offset, &h, sizeof h);
+    std::memcpy(ring + offset + sizeof h, data, size);
+    // publishing the tail is what makes the record visible, all at once
+    lane->tail.store(tail + gap + need, std::memory_order_release);
+}
+
+void logger::SharedRingBuffer::drain_to(int fd, std::chrono::microseconds window) {
+    if (!control || drainer) return;
+    drainer = std::make_unique<Drainer>();
+    drainer->fd = fd;
+    drainer->window = window;
+    drainer->thread = std::thread(&SharedRingBuffer::run, this);
+}
+
+/**
+ * @brief Merges and writes out every published record stamped at or before
+ * horizon, then frees the drained lanes of exited threads and dead processes.
+ *
+ * @return Whether anything was written.
+ */
+bool logger::SharedRingBuffer::collect(int fd, std::uint64_t horizon) {
+    struct Cursor {
+	Lane* lane;
+	char* data;
+	std::uint64_t pos;
+	std::uint64_t tail;
+	const Header* header;
+    };
+    std::size_t lane_size = control->lane_size;
+    Lane* lanes = this->lanes();
+
+    auto next = [lane_size](Cursor& c) {
+	while (c.pos < c.tail) {
+	    std::size_t offset = c.pos & (lane_size - 1);
+	    c.header = reinterpret_cast<const Header*>(c.data + offset);
+	    if (c.header->size != skip) return true;
+	    c.pos += lane_size - offset;
+	}
+	c.header = nullptr;
+	return false;
+    };
+    std::vector<Cursor> cursors;
+    for (std::size_t i = 0; i < control->lanes; i++) {
+	Cursor c{&lanes[i], lane_data(i), lanes[i].head.load(std::memory_order_relaxed),
+		 lanes[i].tail.load(std::memory_order_acquire), nullptr};
+	if (c.pos == c.tail) continue;
+	next(c);
+	cursors.push_back(c);
+    }
+
+    auto later = [&cursors](std::size_t a, std::size_t b) {
+	return cursors[a].header->stamp > cursors[b].header->stamp;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+    for (std::size_t i = 0; i < cursors.size(); i++)
+	if (cursors[i].header && cursors[i].header->stamp <= horizon) heap.push(i);
+
+    std::string batch;
+    while (!heap.empty()) {
+	std::size_t i = heap.top();
+	Cursor& c = cursors[i];
+	heap.pop();
+	batch.append(reinterpret_cast<const char*>(c.header + 1), c.header->size);
+	c.pos += align(sizeof(Header) + c.header->size);
+	if (next(c) && c.header->stamp <= horizon) heap.push(i);
+    }
+    write_all(fd, batch.data(), batch.size());
+    if (!batch.empty()) telemetry::flush();
+    for (auto& c : cursors) c.lane->head.store(c.pos, std::memory_order_release);
+
+    DropCounts counts{};
+    bool dropped = false;
+    for (int level = 0; level < 5; level++) {
+	counts[level] = control->dropped[level].exchange(0, std::memory_order_relaxed);
+	dropped |= counts[level] != 0;
+    }
+    if (dropped) {
+	std::string report = reporter(counts);
+	write_all(fd, report.data(), report.size());
+    }
+
+    // start times are read from /proc about once a second, not every pass
+    std::uint64_t now = now_ns();
+    bool verify = now - drainer->verified_at >= 1000000000;
+    if (verify) drainer->verified_at = now;
+    for (std::size_t i = 0; i < control->lanes; i++) {
+	Lane& lane = lanes[i];
+	std::int32_t owner = lane.owner.load(std::memory_order_acquire);
+	if (owner == 0 || lane.head.load(std::memory_order_relaxed) !=
+			      lane.tail.load(std::memory_order_acquire))
+	    continue;
+	if (lane.closed.load(std::memory_order_acquire) ||
+	    !alive(owner, lane.started.load(std::memory_order_acquire), verify)) {
+	    lane.closed.store(0, std::memory_order_relaxed);
+	    lane.started.store(0, std::memory_order_relaxed);
+	    lane.owner.store(0, std::memory_order_release);
+	}
+    }
+    return !batch.empty();
+}
+
+void logger::SharedRingBuffer::run() {
+    Drainer& d = *drainer;
+    std::unique_lock<std::mutex> lock(d.mutex);
+    while (!d.done) {
+	d.wake.wait_for(lock, d.window / 2 + std::chrono::microseconds(1));
+	lock.unlock();
+	std::uint64_t horizon = now_ns();
+	if (!control->pressure.exchange(false, std::memory_order_relaxed))
+	    horizon -= std::chrono::duration_cast<std::chrono::nanoseconds>(d.window).count();
+	collect(d.fd, horizon);
+	lock.lock();
+    }
+    lock.unlock();
+    while (collect(d.fd, UINT64_MAX)) {
+    }
+}
@@ -0,0 +1,500 @@
+#include "ptclogs/sink/shipping_buffer.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ptclogs/telemetry.hpp"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Records of one frame, and the levels of the records it stands for,
+ * which are counted as dropped if the frame is. A drop report stands for
+ * records that were counted when they were dropped.
+ */
+struct Frame {
+    std::string payload;
+    logger::DropCounts counts{};
+    bool report = false;
+};
+
+void big_endian(std::uint32_t n, unsigned char* out) {
+    out[0] = n >> 24;
+    out[1] = n >> 16;
+    out[2] = n >> 8;
+    out[3] = n;
+}
+
+std::uint32_t big_endian(const unsigned char* in) {
+    return std::uint32_t(in[0]) << 24 | std::uint32_t(in[1]) << 16 | std::uint32_t(in[2]) << 8 |
+	   in[3];
+}
+
+/**
+ * @brief Connects a stream socket with non-blocking connect, so an
+ * unreachable host costs at most timeout.
+ */
+int connect_socket(int family, const sockaddr* addr, socklen_t size,
+		   std::chrono::milliseconds timeout) {
+    int fd = socket(family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, addr, size) < 0) {
+	pollfd p{fd, POLLOUT, 0};
+	int error = 0;
+	socklen_t length = sizeof error;
+	if (errno != EINPROGRESS || poll(&p, 1, timeout.count()) != 1 ||
+	    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error) {
+	    close(fd);
+	    return -1;
+	}
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    // a collector that stops reading is taken as down instead of blocking forever
+    timeval tv{timeout.count() / 1000, suseconds_t(timeout.count() % 1000 * 1000)};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+    if (family != AF_UNIX) {
+	int one = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    }
+    return fd;
+}
+
+/**
+ * @brief Connects to "unix:PATH" or "tcp:HOST:PORT".
+ */
+int connect_to(const std::string& address, std::chrono::milliseconds timeout) {
+    if (address.compare(0, 5, "unix:") == 0) {
+	sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	std::string path = address.substr(5);
+	if (path.size() >= sizeof addr.sun_path) return -1;
+	memcpy(addr.sun_path, path.data(), path.size());
+	return connect_socket(AF_UNIX, reinterpret_cast<sockaddr*>(&addr), sizeof addr, timeout);
+    }
+    if (address.compare(0, 4, "tcp:") != 0) return -1;
+    std::size_t colon = address.rfind(':');
+    if (colon <= 4) return -1;
+    std::string host = address.substr(4, colon - 4);
+    std::string port = address.substr(colon + 1);
+    // [::1]:514 style hosts
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+	host = host.substr(1, host.size() - 2);
+    addrinfo hints{};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) return -1;
+    int fd = -1;
+    for (addrinfo* a = found; a && fd < 0; a = a->ai_next)
+	fd = connect_socket(a->ai_family, a->ai_addr, a->ai_addrlen, timeout);
+    freeaddrinfo(found);
+    return fd;
+}
+
+/**
+ * @brief Sends frames with one sendmsg for as many as fit in an iovec array.
+ *
+ * @param sent Set to the number of frames written whole. A frame cut by a
+ * failure is dropped by the collector, so it is sent again from the start.
+ * @return Whether all of them were sent.
+ */
+bool send_frames(int fd, const std::vector<std::string_view>& payloads, std::size_t& sent) {
+    const std::size_t per_call = IOV_MAX / 2;
+    std::vector<unsigned char> headers(payloads.size() * 4);
+    std::vector<iovec> iov;
+    for (std::size_t from = 0; from < payloads.size(); from += per_call) {
+	std::size_t to = std::min(payloads.size(), from + per_call);
+	iov.clear();
+	for (std::size_t i = from; i < to; i++) {
+	    big_endian(payloads[i].size(), &headers[i * 4]);
+	    iov.push_back(iovec{&headers[i * 4], 4});
+	    iov.push_back(iovec{const_cast<char*>(payloads[i].data()), payloads[i].size()});
+	}
+	std::size_t first = 0;
+	while (first < iov.size()) {
+	    msghdr msg{};
+	    msg.msg_iov = &iov[first];
+	    msg.msg_iovlen = iov.size() - first;
+	    ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+	    if (n < 0) {
+		if (errno == EINTR) continue;
+		// a frame is two vectors, its header and its payload
+		sent = from + first / 2;
+		return false;
+	    }
+	    // skip what was sent, the last vector may be cut halfway
+	    while (first < iov.size() && std::size_t(n) >= iov[first].iov_len)
+		n -= iov[first++].iov_len;
+	    if (first < iov.size()) {
+		iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + n;
+		iov[first].iov_len -= n;
+	    }
+	}
+    }
+    sent = payloads.size();
+    return true;
+}
+
+/**
+ * @brief Frames kept on disk while the collector is down, in the wire format,
+ * appended at the end and replayed from the start.
+ */
+class Spool {
+  public:
+    Spool(const std::string& path, std::uint64_t limit) : limit(limit) {
+	if (path.empty()) return;
+	fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) return;
+	struct stat st;
+	if (fstat(fd, &st) == 0) size = st.st_size;
+	// a crash may have cut the last frame
+	std::uint64_t end = 0;
+	unsigned char header[4];
+	while (end + 4 <= size && pread(fd, header, 4, end) == 4 &&
+	       end + 4 + big_endian(header) <= size)
+	    end += 4 + big_endian(header);
+	if (end != size && ftruncate(fd, end) == 0) size = end;
+    }
+
+    ~Spool() {
+	if (fd >= 0) close(fd);
+    }
+
+    bool enabled() const { return fd >= 0; }
+    bool empty() const { return read == size; }
+    std::uint64_t pending() const { return size - read; }
+
+    /**
+     * @brief Appends a frame.
+     *
+     * @return Whether it fit.
+     */
+    bool append(const std::string& payload) {
+	if (fd < 0 || size + 4 + payload.size() > limit) return false;
+	unsigned char header[4];
+	big_endian(payload.size(), header);
+	iovec iov[2] = {{header, 4}, {const_cast<char*>(payload.data()), payload.size()}};
+	ssize_t n = pwritev(fd, iov, 2, size);
+	if (n != ssize_t(4 + payload.size())) {
+	    // a partial frame is overwritten by the next one
+	    return false;
+	}
+	size += n;
+	return true;
+    }
+
+    /**
+     * @brief Sends the spooled frames in order, a chunk at a time. Frames
+     * sent before a failure are not sent again.
+     *
+     * @return Whether all of them were sent.
+     */
+    bool replay(int socket) {
+	const std::uint64_t chunk = 1 << 20;
+	std::string data;
+	std::vector<std::string_view> payloads;
+	while (!empty()) {
+	    data.resize(std::min(chunk, size - read));
+	    if (pread(fd, data.data(), data.size(), read) != ssize_t(data.size())) return false;
+	    payloads.clear();
+	    std::size_t at = 0;
+	    while (at + 4 <= data.size()) {
+		std::uint32_t length = big_endian(reinterpret_cast<unsigned char*>(&data[at]));
+		if (at + 4 + length > data.size()) break;
+		payloads.emplace_back(data.data() + at + 4, length);
+		at += 4 + length;
+	    }
+	    if (payloads.empty()) {
+		// a frame larger than a chunk
+		std::uint32_t length = big_endian(reinterpret_cast<unsigned char*>(&data[0]));
+		data.resize(4 + length);
+		if (pread(fd, data.data(), data.size(), read) != ssize_t(data.size())) return false;
+		payloads.emplace_back(data.data() + 4, length);
+		at = data.size();
+	    }
+	    std::size_t sent;
+	    if (!send_frames(socket, payloads, sent)) {
+		if (sent) read += payloads[sent - 1].data() + payloads[sent - 1].size() - data.data();
+		return false;
+	    }
+	    read += at;
+	}
+	// the file is restarted once it is all sent
+	read = size = 0;
+	if (ftruncate(fd, 0) != 0) return false;
+	return true;
+    }
+
+  private:
+    int fd = -1;
+    std::uint64_t limit;
+    std::uint64_t size = 0;
+    std::uint64_t read = 0;
+};
+}  // namespace
+
+/**
+ * @brief State of the sender thread: the connection, its backoff, the spool
+ * and the frames that couldn't go anywhere yet.
+ */
+struct logger::ShippingBuffer::Sender {
+    Sender(const std::string& address, const ShippingOptions& options)
+	: address(address),
+	  options(options),
+	  spool(options.spool, options.spool_bytes),
+	  backoff(options.min_backoff) {}
+
+    ~Sender() { disconnect(); }
+
+    bool connected() const { return fd >= 0; }
+
+    /**
+     * @brief Connects if the backoff allows it, or right away when forced.
+     */
+    void connect(bool force = false) {
+	if (connected() || (!force && Clock::now() < next_attempt)) return;
+	fd = connect_to(address, options.timeout);
+	if (connected()) {
+	    backoff = options.min_backoff;
+	} else {
+	    next_attempt = Clock::now() + backoff;
+	    backoff = std::min(backoff * 2, options.max_backoff);
+	}
+    }
+
+    void disconnect() {
+	if (fd >= 0) close(fd);
+	fd = -1;
+	next_attempt = Clock::now() + backoff;
+    }
+
+    /**
+     * @brief Sends what is spooled and held back, oldest first.
+     *
+     * @return Whether nothing is left.
+     */
+    bool catch_up() {
+	if (!connected()) return false;
+	if (!spool.empty() && !spool.replay(fd)) {
+	    disconnect();
+	    return false;
+	}
+	if (held.empty()) return true;
+	if (!send(held)) return false;
+	held.clear();
+	return true;
+    }
+
+    /**
+     * @brief Sends frames, leaving in frames those that weren't sent whole.
+     */
+    bool send(std::vector<Frame>& frames) {
+	std::vector<std::string_view> payloads;
+	for (auto& frame : frames) payloads.emplace_back(frame.payload);
+	std::size_t sent;
+	if (send_frames(fd, payloads, sent)) return true;
+	frames.erase(frames.begin(), frames.begin() + sent);
+	disconnect();
+	return false;
+    }
+
+    /**
+     * @brief Sends frames, or spools them or holds them back while the
+     * collector is down. Frames the spool has no room for are dropped.
+     */
+    void deliver(std::vector<Frame>& frames) {
+	if (catch_up() && send(frames)) return;
+	if (!spool.enabled()) {
+	    for (auto& frame : frames) held.push_back(std::move(frame));
+	    return;
+	}
+	for (auto& frame : held) spool_or_drop(frame);
+	held.clear();
+	for (auto& frame : frames) spool_or_drop(frame);
+    }
+
+    void spool_or_drop(const Frame& frame) {
+	if (spool.append(frame.payload)) return;
+	for (int level = 0; level < int(dropped.size()); level++) {
+	    dropped[level] += frame.counts[level];
+	    count_drops(frame, level);
+	}
+    }
+
+    /**
+     * @brief Drops what is held back, when stopping with nowhere to put it.
+     */
+    void discard_held() {
+	for (auto& frame : held)
+	    for (int level = 0; level < int(dropped.size()); level++) count_drops(frame, level);
+	held.clear();
+    }
+
+    static void count_drops(const Frame& frame, int level) {
+	if (frame.report) return;
+	for (std::uint64_t i = 0; i < frame.counts[level]; i++) telemetry::drop(LogLevel(level));
+    }
+
+    /**
+     * @brief Returns whether new records can be taken: frames held back wait
+     * for the collector when there is no spool to put the next ones in.
+     */
+    bool accepting() const { return connected() || spool.enabled() || held.empty(); }
+
+    std::string address;
+    ShippingOptions options;
+    Spool spool;
+    std::vector<Frame> held;
+    DropCounts dropped{};
+    int fd = -1;
+    std::chrono::milliseconds backoff;
+    Clock::time_point next_attempt{};
+};
+
+logger::ShippingBuffer::ShippingBuffer(const std::string& address, ShippingOptions options,
+				       OverflowPolicy policy, DropReporter reporter)
+    : address(address), options(options), queue(policy), reporter(reporter) {
+    sender = std::thread(&ShippingBuffer::run, this);
+}
+
+logger::ShippingBuffer::~ShippingBuffer() {
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+    }
+    has_records.notify_one();
+    sender.join();
+}
+
+std::size_t logger::ShippingBuffer::pending() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+std::uint64_t logger::ShippingBuffer::spooled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return spool_size;
+}
+
+bool logger::ShippingBuffer::connected() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return is_connected;
+}
+
+void logger::ShippingBuffer::commit(LogLevel level, const char* data, std::size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!enqueue(lock, level, data, size)) return;
+    lock.unlock();
+    has_records.notify_one();
+}
+
+void logger::ShippingBuffer::commit_batch(const char* data, const BatchRecord* records,
+					  std::size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool queued = false;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < count; i++) {
+	queued |= enqueue(lock, records[i].level, data + start, records[i].end - start);
+	start = records[i].end;
+    }
+    lock.unlock();
+    if (queued) has_records.notify_one();
+}
+
+bool logger::ShippingBuffer::enqueue(std::unique_lock<std::mutex>& lock, LogLevel level,
+				     const char* data, std::size_t size) {
+    auto deadline = std::chrono::steady_clock::now() + queue.get_policy().timeout;
+    while (true) {
+	bool expired = std::chrono::steady_clock::now() >= deadline;
+	switch (queue.admit(level, size, expired)) {
+	    case RecordQueue::ADMIT:
+		queue.push(level, data, size);
+		return true;
+	    case RecordQueue::DROP:
+		queue.drop(level);
+		return false;
+	    case RecordQueue::WAIT:
+		has_records.notify_one();
+		if (queue.get_policy().mode == OverflowMode::BLOCK_TIMEOUT)
+		    has_room.wait_until(lock, deadline);
+		else
+		    has_room.wait(lock);
+		break;
+	}
+    }
+}
+
+void logger::ShippingBuffer::run() {
+    Sender s(address, options);
+    std::pmr::deque<RecordQueue::Record> batch(memory::resource());
+    std::vector<Frame> frames;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+	bool stopping = done;
+	lock.unlock();
+	s.connect(stopping);
+	s.catch_up();
+	lock.lock();
+	is_connected = s.connected();
+	spool_size = s.spool.pending();
+
+	if (!s.accepting() || queue.empty()) {
+	    if (stopping) {
+		// the collector is down and there is no spool: what is left is lost
+		s.discard_held();
+		queue.take(batch);
+		for (auto& record : batch) telemetry::drop(record.level);
+		return;
+	    }
+	    auto ready = [this] { return done || !queue.empty(); };
+	    if (s.connected())
+		has_records.wait(lock, ready);
+	    else if (s.accepting())
+		// wakes up for the next reconnection attempt
+		has_records.wait_until(lock, s.next_attempt, ready);
+	    else
+		has_records.wait_until(lock, s.next_attempt, [this] { return done; });
+	    continue;
+	}
+
+	queue.take(batch);
+	DropCounts counts;
+	bool dropped = queue.take_drops(counts);
+	lock.unlock();
+	has_room.notify_all();
+
+	frames.clear();
+	for (auto& record : batch) {
+	    if (frames.empty() ||
+		frames.back().payload.size() + record.data.size() > options.frame_bytes)
+		frames.emplace_back();
+	    frames.back().payload += record.data;
+	    frames.back().counts[record.level]++;
+	}
+	// the report goes in a frame of its own, standing for what it reports
+	for (std::size_t level = 0; level < counts.size(); level++) {
+	    counts[level] += s.dropped[level];
+	    dropped |= s.dropped[level] > 0;
+	}
+	s.dropped = DropCounts{};
+	if (dropped) frames.push_back(Frame{reporter(counts), counts, true});
+
+	s.deliver(frames);
+	telemetry::flush();
+	lock.lock();
+    }
+}
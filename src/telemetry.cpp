@@ -0,0 +1,183 @@
+#include "ptclogs/telemetry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace {
+using logger::telemetry::Counters;
+using logger::telemetry::Snapshot;
+
+/**
+ * @brief Counters of live threads and the sum of those of finished threads.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<Counters*> live;
+    Snapshot retired;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry();  // outlives thread_local destructors
+    return *r;
+}
+
+void accumulate(Snapshot& s, const Counters& c) {
+    auto load = [](const std::atomic<std::uint64_t>& a) {
+	return a.load(std::memory_order_relaxed);
+    };
+    for (int level = 0; level < 5; level++) {
+	s.records[level] += load(c.records[level]);
+	s.bytes[level] += load(c.bytes[level]);
+	s.drops[level] += load(c.drops[level]);
+	for (std::size_t b = 0; b < logger::telemetry::histogram_buckets; b++)
+	    s.latency[level].counts[b] += load(c.latency[level][b]);
+	s.latency_ns[level] += load(c.latency_ns[level]);
+    }
+    s.flushes += load(c.flushes);
+    s.queue_high_water = std::max(s.queue_high_water, load(c.queue_high_water));
+}
+
+/**
+ * @brief Registers the counters of a thread for its lifetime.
+ */
+struct Registration {
+    std::unique_ptr<Counters> counters = std::make_unique<Counters>();
+    Registration() {
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	registry().live.push_back(counters.get());
+    }
+    ~Registration() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	accumulate(r.retired, *counters);
+	r.live.erase(std::find(r.live.begin(), r.live.end(), counters.get()));
+    }
+};
+}  // namespace
+
+#ifdef PTCLOGS_TELEMETRY
+logger::telemetry::Counters& logger::telemetry::local() {
+    static thread_local Registration registration;
+    return *registration.counters;
+}
+#endif
+
+std::uint64_t logger::telemetry::Histogram::count() const {
+    std::uint64_t total = 0;
+    for (auto c : counts) total += c;
+    return total;
+}
+
+std::uint64_t logger::telemetry::Histogram::percentile(double p) const {
+    std::uint64_t total = count();
+    if (total == 0) return 0;
+    std::uint64_t rank = std::uint64_t(p / 100 * (total - 1)) + 1, seen = 0;
+    for (std::size_t b = 0; b < histogram_buckets; b++) {
+	seen += counts[b];
+	if (seen >= rank) return bucket_limit(b);
+    }
+    return bucket_limit(histogram_buckets - 1);
+}
+
+logger::telemetry::Snapshot logger::telemetry::snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Snapshot s = r.retired;
+    for (auto* c : r.live) accumulate(s, *c);
+    return s;
+}
+
+std::string logger::telemetry::to_prometheus(const Snapshot& s) {
+    static const char* levels[] = {"fatal", "error", "warn", "info", "debug"};
+    std::string out;
+    char line[256];
+    auto per_level = [&](const char* name, const char* help,
+			 const std::array<std::uint64_t, 5>& values) {
+	snprintf(line, sizeof line, "# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+	out += line;
+	for (int i = 0; i < 5; i++) {
+	    snprintf(line, sizeof line, "%s{level=\"%s\"} %llu\n", name, levels[i],
+		     (unsigned long long)values[i]);
+	    out += line;
+	}
+    };
+    per_level("ptclogs_records_total", "Records logged.", s.records);
+    per_level("ptclogs_bytes_total", "Bytes committed to record buffers.", s.bytes);
+    per_level("ptclogs_dropped_total", "Records dropped under backpressure.", s.drops);
+    snprintf(line, sizeof line,
+	     "# HELP ptclogs_flushes_total Writes to the output.\n"
+	     "# TYPE ptclogs_flushes_total counter\nptclogs_flushes_total %llu\n"
+	     "# HELP ptclogs_queue_high_water_bytes Largest queue depth seen.\n"
+	     "# TYPE ptclogs_queue_high_water_bytes gauge\n"
+	     "ptclogs_queue_high_water_bytes %llu\n",
+	     (unsigned long long)s.flushes, (unsigned long long)s.queue_high_water);
+    out += line;
+
+    out += "# HELP ptclogs_call_seconds Time spent inside logging calls.\n"
+	   "# TYPE ptclogs_call_seconds histogram\n";
+    for (int i = 0; i < 5; i++) {
+	const Histogram& h = s.latency[i];
+	std::uint64_t cumulative = 0;
+	std::size_t b = 0;
+	// the fine buckets end right below powers of two, so they fold into
+	// the coarse ones exactly. Every bound is written, so the le labels are
+	// the same across scrapes and levels.
+	for (int shift = 10; shift <= 34; shift += 2) {
+	    std::uint64_t le = std::uint64_t(1) << shift;
+	    for (; b < histogram_buckets && bucket_limit(b) < le; b++) cumulative += h.counts[b];
+	    snprintf(line, sizeof line, "ptclogs_call_seconds_bucket{level=\"%s\",le=\"%.9f\"} %llu\n",
+		     levels[i], le / 1e9, (unsigned long long)cumulative);
+	    out += line;
+	}
+	for (; b < histogram_buckets; b++) cumulative += h.counts[b];
+	snprintf(line, sizeof line,
+		 "ptclogs_call_seconds_bucket{level=\"%s\",le=\"+Inf\"} %llu\n"
+		 "ptclogs_call_seconds_sum{level=\"%s\"} %.9f\n"
+		 "ptclogs_call_seconds_count{level=\"%s\"} %llu\n",
+		 levels[i], (unsigned long long)cumulative, levels[i], s.latency_ns[i] / 1e9, levels[i],
+		 (unsigned long long)cumulative);
+	out += line;
+    }
+    return out;
+}
+
+logger::telemetry::Reporter::Reporter(std::function<void(const Snapshot&)> callback,
+				      std::chrono::milliseconds period)
+    : callback(callback), period(period) {
+    thread = std::thread(&Reporter::run, this);
+}
+
+logger::telemetry::Reporter::Reporter(std::string path, std::chrono::milliseconds period)
+    : Reporter(
+	  [path](const Snapshot& s) {
+	      // write aside and rename, so scrapers never see a partial file
+	      std::string tmp = path + ".tmp";
+	      {
+		  std::ofstream f(tmp, std::ios::trunc);
+		  f << to_prometheus(s);
+	      }
+	      std::rename(tmp.c_str(), path.c_str());
+	  },
+	  period) {}
+
+logger::telemetry::Reporter::~Reporter() {
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	done = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void logger::telemetry::Reporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!done) {
+	wake.wait_for(lock, period, [this] { return done; });
+	lock.unlock();
+	callback(snapshot());
+	lock.lock();
+    }
+}
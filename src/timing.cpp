@@ -0,0 +1,123 @@
+#include "ptclogs/timing.hpp"
+
+namespace {
+std::atomic<std::uint64_t> next_id{1};
+}  // namespace
+
+/**
+ * @brief Histograms of one thread for one summary. Only the owning thread
+ * writes them; it allocates the buckets of a series when first recording it.
+ */
+struct logger::LatencySummary::Local {
+    std::atomic<std::atomic<std::uint64_t>*> series[max_series]{};
+    std::atomic<bool> closed{false};
+
+    ~Local() {
+	for (auto& s : series) delete[] s.load(std::memory_order_relaxed);
+    }
+};
+
+logger::LatencySummary::LatencySummary(Emit emit, std::chrono::milliseconds period)
+    : emit(emit), period(period), id(next_id.fetch_add(1)) {
+    thread = std::thread(&LatencySummary::run, this);
+}
+
+logger::LatencySummary::~LatencySummary() {
+    {
+	std::lock_guard<std::mutex> lock(emit_mutex);
+	done = true;
+    }
+    wake.notify_one();
+    thread.join();
+    emit_now();
+}
+
+logger::LatencySeries logger::LatencySummary::series(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < names.size(); i++)
+	if (names[i] == name) return LatencySeries(*this, i);
+    names.push_back(name);
+    retired.emplace_back();
+    emitted.emplace_back();
+    return LatencySeries(*this, names.size() - 1);
+}
+
+std::atomic<std::uint64_t>* logger::LatencySummary::local(std::size_t series) {
+    if (series >= max_series) return nullptr;
+    // closes the histograms of this thread when it exits, so they get folded.
+    // The summary owns the histograms, slots of destroyed summaries expire.
+    struct Slot {
+	std::uint64_t id;
+	Local* local;
+	std::weak_ptr<Local> owner;
+    };
+    struct Slots {
+	std::vector<Slot> list;
+	~Slots() {
+	    for (auto& slot : list)
+		if (auto l = slot.owner.lock()) l->closed.store(true, std::memory_order_release);
+	}
+    };
+    static thread_local Slots slots;
+    Local* l = nullptr;
+    for (auto& slot : slots.list)
+	if (slot.id == id) l = slot.local;
+    if (!l) {
+	std::erase_if(slots.list, [](const Slot& slot) { return slot.owner.expired(); });
+	auto created = std::make_shared<Local>();
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    locals.push_back(created);
+	}
+	slots.list.push_back(Slot{id, created.get(), created});
+	l = created.get();
+    }
+
+    std::atomic<std::uint64_t>* counts = l->series[series].load(std::memory_order_relaxed);
+    if (!counts) {
+	counts = new std::atomic<std::uint64_t>[telemetry::histogram_buckets]{};
+	l->series[series].store(counts, std::memory_order_release);
+    }
+    return counts;
+}
+
+void logger::LatencySummary::emit_now() {
+    std::vector<std::pair<std::string, telemetry::Histogram>> periods;
+    {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<telemetry::Histogram> totals = retired;
+	for (auto it = locals.begin(); it != locals.end();) {
+	    bool closed = (*it)->closed.load(std::memory_order_acquire);
+	    for (std::size_t s = 0; s < names.size() && s < max_series; s++) {
+		std::atomic<std::uint64_t>* counts = (*it)->series[s].load(std::memory_order_acquire);
+		if (!counts) continue;
+		for (std::size_t b = 0; b < telemetry::histogram_buckets; b++) {
+		    std::uint64_t n = counts[b].load(std::memory_order_relaxed);
+		    totals[s].counts[b] += n;
+		    if (closed) retired[s].counts[b] += n;
+		}
+	    }
+	    it = closed ? locals.erase(it) : it + 1;
+	}
+
+	for (std::size_t s = 0; s < names.size(); s++) {
+	    telemetry::Histogram period;
+	    for (std::size_t b = 0; b < telemetry::histogram_buckets; b++)
+		period.counts[b] = totals[s].counts[b] - emitted[s].counts[b];
+	    emitted[s] = totals[s];
+	    if (period.count()) periods.emplace_back(names[s], period);
+	}
+    }
+    for (auto& [name, period] : periods) emit(name, period);
+}
+
+void logger::LatencySummary::run() {
+    std::unique_lock<std::mutex> lock(emit_mutex);
+    while (!done) {
+	wake.wait_for(lock, period, [this] { return done; });
+	if (done) break;
+	lock.unlock();
+	emit_now();
+	lock.lock();
+    }
+}
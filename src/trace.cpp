@@ -0,0 +1,132 @@
+#include "ptclogs/trace.hpp"
+
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <link.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+namespace {
+/**
+ * @brief A loaded module: the range of its segments and the address it is
+ * loaded at.
+ */
+struct Module {
+    std::uintptr_t start;
+    std::uintptr_t end;
+    std::uintptr_t base;
+    std::string path;
+};
+
+std::mutex modules_mutex;
+// leaked, frames may be rendered while statics are destroyed
+std::vector<Module>& modules = *new std::vector<Module>();
+
+std::string executable_path() {
+    char path[4096];
+    ssize_t n = readlink("/proc/self/exe", path, sizeof path);
+    return n > 0 ? std::string(path, n) : std::string();
+}
+
+int add_module(dl_phdr_info* info, std::size_t, void*) {
+    Module m{UINTPTR_MAX, 0, info->dlpi_addr, info->dlpi_name ? info->dlpi_name : ""};
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+	const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+	if (segment.p_type != PT_LOAD) continue;
+	m.start = std::min<std::uintptr_t>(m.start, info->dlpi_addr + segment.p_vaddr);
+	m.end = std::max<std::uintptr_t>(m.end, info->dlpi_addr + segment.p_vaddr + segment.p_memsz);
+    }
+    if (m.start >= m.end) return 0;
+    // the executable has no name
+    if (m.path.empty()) m.path = executable_path();
+    modules.push_back(std::move(m));
+    return 0;
+}
+
+void load_modules() {
+    modules.clear();
+    dl_iterate_phdr(add_module, nullptr);
+    std::sort(modules.begin(), modules.end(),
+	      [](const Module& a, const Module& b) { return a.start < b.start; });
+}
+
+const Module* find_module(std::uintptr_t address) {
+    auto it = std::upper_bound(modules.begin(), modules.end(), address,
+			       [](std::uintptr_t a, const Module& m) { return a < m.start; });
+    if (it == modules.begin()) return nullptr;
+    --it;
+    return address < it->end ? &*it : nullptr;
+}
+
+std::string demangle(const char* name) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    std::string result = status == 0 && demangled ? demangled : name;
+    free(demangled);
+    return result;
+}
+
+// the first backtrace loads the unwinder, which allocates; done up front so
+// captures on error paths don't
+[[maybe_unused]] const bool unwinder_loaded = [] {
+    void* frame;
+    backtrace(&frame, 1);
+    return true;
+}();
+}  // namespace
+
+logger::StackTrace logger::StackTrace::capture(int skip) {
+    void* frames[max_frames + 16];
+    skip = std::clamp(skip + 1, 1, 16);
+    StackTrace trace;
+    int n = backtrace(frames, max_frames + skip);
+    trace.size = std::max(0, n - skip);
+    std::memcpy(trace.frames, frames + skip, trace.size * sizeof(void*));
+    return trace;
+}
+
+std::string_view logger::trace::frame(const void* address) {
+    static thread_local std::string text;
+    std::uintptr_t a = reinterpret_cast<std::uintptr_t>(address);
+    char offset[24];
+    std::lock_guard<std::mutex> lock(modules_mutex);
+    const Module* m = find_module(a);
+    if (!m) {
+	// modules loaded since the table was built
+	load_modules();
+	m = find_module(a);
+    }
+    if (!m) {
+	snprintf(offset, sizeof offset, "0x%" PRIxPTR, a);
+	text = offset;
+	return text;
+    }
+    snprintf(offset, sizeof offset, "+0x%" PRIxPTR, a - m->base);
+    text = m->path;
+    text += offset;
+    return text;
+}
+
+logger::ExceptionInfo logger::trace::inspect(const std::exception_ptr& error) {
+    ExceptionInfo info;
+    try {
+	std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+	info.type = demangle(typeid(e).name());
+	info.what = e.what();
+	info.standard = true;
+    } catch (...) {
+	const std::type_info* type = abi::__cxa_current_exception_type();
+	info.type = type ? demangle(type->name()) : "unknown";
+    }
+    return info;
+}
@@ -0,0 +1,87 @@
+#include <dirent.h>
+#include <unistd.h>
+
+#include <ptclogs/callsite.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+CallSite nested("src/cache/cache.cpp", 120, "handle_get", LogLevel::DEBUG);
+CallSite flat("cache.cpp", 7, "evict", LogLevel::DEBUG);
+CallSite other("src/server.cpp", 42, "serve", LogLevel::DEBUG);
+CallSite late("cache.cpp", 9, "evict", LogLevel::DEBUG);
+
+/**
+ * @brief Returns the number of threads of the process.
+ */
+int threads() {
+  int n = 0;
+  DIR* dir = opendir("/proc/self/task");
+  while (dirent* entry = readdir(dir)) n += entry->d_name[0] != '.';
+  closedir(dir);
+  return n;
+}
+}  // namespace
+
+TEST(callsite_patterns_match_file_basename) {
+  callsites::reset();
+  for (CallSite* site : {&nested, &flat, &other}) site->enabled(LogLevel::INFO);
+  CHECK(callsites::apply("+cache.cpp:*") == 2);
+  CHECK(nested.enabled(LogLevel::INFO));
+  CHECK(flat.enabled(LogLevel::INFO));
+  CHECK(!other.enabled(LogLevel::INFO));
+  CHECK(callsites::apply("-src/*.cpp:42") == 1);
+  CHECK(callsites::apply("-handle_*") == 1);
+  CHECK(!nested.enabled(LogLevel::DEBUG));
+}
+
+TEST(callsite_replace_sets_every_site_at_once) {
+  callsites::reset();
+  CHECK(callsites::apply("+*") == 3);
+  callsites::replace({"-serve", "# not a rule", "=evict"});
+  CHECK(!nested.enabled(LogLevel::INFO));
+  CHECK(nested.enabled(LogLevel::DEBUG));
+  CHECK(!other.enabled(LogLevel::DEBUG));
+  CHECK(!flat.enabled(LogLevel::INFO));
+}
+
+TEST(callsite_rule_replaces_same_pattern) {
+  callsites::reset();
+  for (int i = 0; i < 1000; i++) callsites::apply(i % 2 ? "-evict" : "+evict");
+  CHECK(!flat.enabled(LogLevel::DEBUG));
+  // a site that runs for the first time takes the state of the last rule only
+  CHECK(!late.enabled(LogLevel::DEBUG));
+  callsites::apply("=evict");
+  CHECK(late.enabled(LogLevel::DEBUG));
+}
+
+TEST(callsite_watch_runs_one_thread) {
+  callsites::reset();
+  char first[] = "/tmp/ptclogs-watch-XXXXXX", second[] = "/tmp/ptclogs-watch-XXXXXX";
+  close(mkstemp(first));
+  close(mkstemp(second));
+  std::ofstream(second) << "-serve\n";
+  int before = threads();
+  callsites::watch(first, std::chrono::milliseconds(10));
+  // the same thread moves to the second file
+  callsites::watch(second, std::chrono::milliseconds(10));
+  CHECK(threads() == before + 1);
+  for (int i = 0; i < 200 && other.enabled(LogLevel::DEBUG); i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(!other.enabled(LogLevel::DEBUG));
+  callsites::unwatch();
+  CHECK(threads() == before);
+  callsites::reset();
+  unlink(first);
+  unlink(second);
+}
+
+int main() { return check::run_tests(); }
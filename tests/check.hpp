@@ -0,0 +1,63 @@
+#ifndef PTCLOGS_TESTS_CHECK_HPP
+#define PTCLOGS_TESTS_CHECK_HPP
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Minimal test harness: every test file registers its cases with TEST and
+ * runs them from main with run_tests, which reports failed checks and
+ * returns the exit status.
+ */
+namespace check {
+struct Case {
+  const char* name;
+  void (*run)();
+};
+
+inline std::vector<Case>& cases() {
+  static std::vector<Case> all;
+  return all;
+}
+
+inline int failures = 0;
+
+struct Register {
+  Register(const char* name, void (*run)()) { cases().push_back(Case{name, run}); }
+};
+
+inline void fail(const char* file, int line, const char* expression) {
+  fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+  failures++;
+}
+
+/**
+ * @brief Returns how many times needle occurs in text.
+ */
+inline std::size_t count(std::string_view text, std::string_view needle) {
+  std::size_t n = 0;
+  for (auto at = text.find(needle); at != text.npos; at = text.find(needle, at + needle.size()))
+    n++;
+  return n;
+}
+
+inline int run_tests() {
+  for (auto& c : cases()) {
+    int before = failures;
+    c.run();
+    printf("%-48s %s\n", c.name, failures == before ? "ok" : "FAILED");
+  }
+  return failures ? 1 : 0;
+}
+};  // namespace check
+
+#define TEST(name)                                  \
+  static void name();                               \
+  static check::Register name##_registered(#name, name); \
+  static void name()
+
+#define CHECK(expression) \
+  ((expression) ? void() : check::fail(__FILE__, __LINE__, #expression))
+
+#endif  // PTCLOGS_TESTS_CHECK_HPP
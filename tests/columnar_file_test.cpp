@@ -0,0 +1,82 @@
+#include <unistd.h>
+
+#include <ptclogs/columnar.hpp>
+#include <ptclogs/reader.hpp>
+#include <ptclogs/sink/columnar_file.hpp>
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::string temporary_path() {
+  char path[] = "/tmp/ptclogs-columns-XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  unlink(path);
+  return path;
+}
+
+/**
+ * @brief Returns the records in the segment at path.
+ */
+std::size_t count_records(const std::string& path) {
+  reader::MappedFile file;
+  if (!file.open(path)) return 0;
+  std::size_t records = 0;
+  columnar::for_each_block(file.data(),
+                           [&](const columnar::Block& block) { records += block.records; });
+  return records;
+}
+}  // namespace
+
+TEST(columnar_file_keeps_record_ts) {
+  std::string path = temporary_path();
+  {
+    columnar::SegmentOptions options;
+    options.flush_interval = std::chrono::milliseconds(0);
+    ColumnarFileBuffer buffer(path, options);
+    std::ostream stream(&buffer);
+    stream << "{\"ts\":\"2020-01-02T03:04:05Z\",\"level\":\"INFO\",\"msg\":\"a\"}\n" << std::flush;
+    stream << "{\"ts\":\"2020-01-02T03:04:06Z\",\"level\":\"INFO\",\"msg\":\"b\"}\n" << std::flush;
+  }
+  reader::MappedFile file;
+  CHECK(file.open(path));
+  std::vector<std::string_view> values;
+  std::vector<std::string> storage;
+  bool quoted = false;
+  CHECK(columnar::for_each_block(file.data(), [&](const columnar::Block& block) {
+    const columnar::Column* ts = block.find("ts");
+    CHECK(ts && ts->values(block.records, values, storage, quoted));
+  }));
+  CHECK(quoted);
+  CHECK(values.size() == 2 && values[0] == "2020-01-02T03:04:05Z");
+  CHECK(values.size() == 2 && values[1] == "2020-01-02T03:04:06Z");
+  unlink(path.c_str());
+}
+
+TEST(columnar_file_flushes_partial_blocks) {
+  std::string path = temporary_path();
+  {
+    columnar::SegmentOptions options;
+    options.flush_interval = std::chrono::milliseconds(20);
+    ColumnarFileBuffer buffer(path, options);
+    std::ostream stream(&buffer);
+    stream << "{\"ts\":\"2020-01-02T03:04:05Z\",\"level\":\"INFO\",\"msg\":\"a\"}\n" << std::flush;
+    stream << "not json\n" << std::flush;
+    CHECK(count_records(path) == 0);
+    // the records wait at most one and a half intervals
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(count_records(path) == 2);
+  }
+  CHECK(count_records(path) == 2);
+  unlink(path.c_str());
+}
+
+int main() { return check::run_tests(); }
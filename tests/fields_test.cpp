@@ -0,0 +1,20 @@
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ptclogs/fields.hpp>
+
+#include "check.hpp"
+
+using namespace logger;
+
+TEST(thread_id_is_read_again_after_fork) {
+  CHECK(thread_id() == syscall(SYS_gettid));
+  pid_t child = fork();
+  if (child == 0) _exit(thread_id() == syscall(SYS_gettid) ? 0 : 1);
+  int status = -1;
+  waitpid(child, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main() { return check::run_tests(); }
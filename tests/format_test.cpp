@@ -0,0 +1,46 @@
+#include <ptclogs/driver/json_driver.hpp>
+#include <ptclogs/logs.hpp>
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::stringbuf written;
+std::ostream output(&written);
+Logger<JSONDriver, output> parent(LogLevel::INFO);
+
+/**
+ * @brief Prints its name and, while being printed, logs a message formatted
+ * the same way with the next Noisy, if any.
+ */
+struct Noisy {
+  const char* name;
+  const Noisy* next;
+
+  friend std::ostream& operator<<(std::ostream& os, const Noisy& noisy) {
+    os << noisy.name;
+    // the same instantiations as the caller's, so the same buffers were it
+    // not for their depth
+    if (noisy.next) parent.INFO("logged {} {}", *noisy.next, 7);
+    return os << "!";
+  }
+};
+}  // namespace
+
+TEST(format_values_may_log_while_printed) {
+  written.str("");
+  Noisy inner{"inner", nullptr}, outer{"outer", &inner};
+  parent.INFO("logged {} {}", outer, 7);
+  std::string text = written.str();
+  CHECK(check::count(text, "\"msg\":\"logged inner! 7\"") == 1);
+  CHECK(check::count(text, "\"msg\":\"logged outer! 7\"") == 1);
+  // the inner record is written first, while the outer one is formatted
+  CHECK(text.find("inner!") < text.find("outer!"));
+}
+
+int main() { return check::run_tests(); }
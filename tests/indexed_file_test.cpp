@@ -0,0 +1,92 @@
+#include <unistd.h>
+
+#include <ptclogs/clock.hpp>
+#include <ptclogs/index.hpp>
+#include <ptclogs/sink/indexed_file.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+/**
+ * @brief Writes count records with increasing ids, one block each.
+ */
+void write_records(const std::string& path, index::IndexOptions options, int from, int count) {
+  IndexedFileBuffer buffer(path, options);
+  std::ostream stream(&buffer);
+  for (int i = from; i < from + count; i++)
+    stream << "{\"level\":\"INFO\",\"id\":\"r" << i << "\"}\n" << std::flush;
+}
+
+std::string temporary_path() {
+  char path[] = "/tmp/ptclogs-index-XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  unlink(path);
+  return path;
+}
+}  // namespace
+
+TEST(indexed_file_reopens_with_its_index_options) {
+  std::string path = temporary_path();
+  write_records(path, index::IndexOptions{1, 128, {"id"}}, 0, 3);
+  // different options, the existing index keeps its own
+  write_records(path, index::IndexOptions{1 << 16, 4096, {}}, 3, 3);
+  index::Index idx;
+  CHECK(idx.load(path + ".idx"));
+  CHECK(idx.options.bloom_bits == 128);
+  CHECK(idx.options.block_bytes == 1);
+  CHECK(idx.options.keys.size() == 1);
+  CHECK(idx.blocks.size() == 6);
+  CHECK(idx.blocks.size() == 6 && idx.blocks[5].may_contain("id", "r5"));
+  CHECK(idx.blocks.size() == 6 && idx.blocks[5].offset == idx.blocks[4].offset + idx.blocks[4].size);
+  unlink(path.c_str());
+  unlink((path + ".idx").c_str());
+}
+
+TEST(indexed_file_starts_over_on_unreadable_index) {
+  std::string path = temporary_path();
+  write_records(path, index::IndexOptions{1, 128, {"id"}}, 0, 2);
+  std::ofstream(path + ".idx", std::ios::trunc) << "garbage";
+  write_records(path, index::IndexOptions{1, 256, {"id"}}, 2, 2);
+  index::Index idx;
+  CHECK(idx.load(path + ".idx"));
+  CHECK(idx.options.bloom_bits == 256);
+  CHECK(idx.blocks.size() == 2);
+  // the records before are left to be scanned
+  CHECK(idx.blocks.size() == 2 && idx.blocks[0].offset > 0);
+  unlink(path.c_str());
+  unlink((path + ".idx").c_str());
+}
+
+TEST(indexed_file_spans_out_of_order_records) {
+  std::string path = temporary_path();
+  std::uint64_t earlier = clock::stamp();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::uint64_t later = clock::stamp();
+  {
+    IndexedFileBuffer buffer(path, index::IndexOptions{1 << 16, 128, {}});
+    std::ostream stream(&buffer);
+    // a record replayed between two later ones, as a sampled logger does
+    for (std::uint64_t stamp : {later, earlier, later}) {
+      clock::replay_stamp = stamp;
+      stream << "{\"level\":\"INFO\"}\n" << std::flush;
+    }
+    clock::replay_stamp = 0;
+  }
+  index::Index idx;
+  CHECK(idx.load(path + ".idx"));
+  CHECK(idx.blocks.size() == 1);
+  CHECK(idx.blocks.size() == 1 && idx.blocks[0].last_ns - idx.blocks[0].first_ns >= 10'000'000);
+  unlink(path.c_str());
+  unlink((path + ".idx").c_str());
+}
+
+int main() { return check::run_tests(); }
@@ -0,0 +1,77 @@
+#include <ptclogs/driver/json_driver.hpp>
+#include <ptclogs/driver/logfmt_driver.hpp>
+#include <ptclogs/logs.hpp>
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::stringbuf written;
+std::ostream output(&written);
+Logger<JSONDriver, output> json(LogLevel::INFO);
+Logger<LogfmtDriver, output> logfmt(LogLevel::INFO);
+
+/**
+ * @brief Prints text JSON would have to escape.
+ */
+struct Quote {
+  friend std::ostream& operator<<(std::ostream& os, const Quote&) {
+    return os << "say \"hi\"\n";
+  }
+};
+
+struct Twice {};
+struct Mixed {};
+}  // namespace
+
+template <>
+struct logger::serializer<Twice> {
+  template <class Writer>
+  static void write(Writer& w, const Twice&) {
+    w.value(1);
+    w.value(2);
+  }
+};
+
+template <>
+struct logger::serializer<Mixed> {
+  template <class Writer>
+  static void write(Writer& w, const Mixed&) {
+    w.field("a", 1);
+    w.value(2);
+    w.field("b", 3);
+  }
+};
+
+TEST(json_quotes_streamed_values) {
+  written.str("");
+  json.INFO("quote", Field("value", Quote()));
+  json.INFO(Quote());
+  std::string text = written.str();
+  CHECK(check::count(text, "\"value\":\"say \\\"hi\\\"\\n\"") == 1);
+  CHECK(check::count(text, "\"msg\":\"say \\\"hi\\\"\\n\"") == 1);
+  CHECK(check::count(text, "\n") == 2);
+}
+
+TEST(logfmt_quotes_streamed_values) {
+  written.str("");
+  logfmt.INFO("quote", Field("value", Quote()));
+  CHECK(check::count(written.str(), "value=\"say \\\"hi\\\"\\n\"") == 1);
+  CHECK(check::count(written.str(), "\n") == 1);
+}
+
+TEST(serializer_writes_one_value_or_fields) {
+  written.str("");
+  json.INFO("twice", Field("value", Twice()));
+  json.INFO("mixed", Field("value", Mixed()));
+  std::string text = written.str();
+  CHECK(check::count(text, "\"value\":1}") == 1);
+  CHECK(check::count(text, "\"value\":{\"a\":1,\"b\":3}}") == 1);
+}
+
+int main() { return check::run_tests(); }
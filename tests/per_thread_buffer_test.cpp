@@ -0,0 +1,79 @@
+#include <unistd.h>
+
+#include <ptclogs/sink/per_thread_buffer.hpp>
+
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+/**
+ * @brief Reads a pipe until every writer closed it.
+ */
+std::thread read_all(int fd, std::string& text) {
+  return std::thread([fd, &text] {
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof buf)) > 0) text.append(buf, n);
+  });
+}
+}  // namespace
+
+TEST(per_thread_buffer_keeps_records_whole) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  std::thread reader = read_all(fds[0], text);
+  {
+    // small rings, so some records take the direct path while the collector writes
+    PerThreadBuffer buffer(fds[1], std::chrono::microseconds(200), 4096);
+    std::ostream stream(&buffer);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&stream, t] {
+        std::string small(50, 'a' + t), large(3000, 'A' + t);
+        for (int i = 0; i < 500; i++) stream << (i % 10 ? small : large) << '\n' << std::flush;
+      });
+    }
+    for (auto& t : threads) t.join();
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+  std::size_t lines = 0, start = 0;
+  bool whole = true;
+  for (std::size_t end = text.find('\n'); end != text.npos; end = text.find('\n', start)) {
+    std::string_view line(text.data() + start, end - start);
+    whole &= (line.size() == 50 || line.size() == 3000) &&
+             line.find_first_not_of(line[0]) == line.npos;
+    lines++;
+    start = end + 1;
+  }
+  CHECK(whole);
+  CHECK(lines == 2000);
+}
+
+TEST(per_thread_buffer_thread_outlives_buffers) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  std::thread reader = read_all(fds[0], text);
+  // a thread outliving many buffers keeps working with each new one
+  for (int i = 0; i < 200; i++) {
+    PerThreadBuffer buffer(fds[1], std::chrono::microseconds(100), 4096);
+    std::ostream stream(&buffer);
+    stream << "record " << i << '\n' << std::flush;
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+  CHECK(check::count(text, "\n") == 200);
+  CHECK(check::count(text, "record 199\n") == 1);
+}
+
+int main() { return check::run_tests(); }
@@ -0,0 +1,153 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ptclogs/reader.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+/**
+ * @brief Returns the fields of record as "key=value" strings, with a *
+ * after quoted values.
+ */
+std::vector<std::string> fields(const reader::Record& record) {
+  std::vector<std::string> all;
+  record.for_each_field([&](const reader::Field& field) {
+    all.push_back(std::string(field.key) + "=" + std::string(field.value) + (field.quoted ? "*" : ""));
+  });
+  return all;
+}
+
+std::string temporary_path() {
+  char path[] = "/tmp/ptclogs-reader-XXXXXX";
+  int fd = mkstemp(path);
+  close(fd);
+  unlink(path);
+  return path;
+}
+
+std::string read_file(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+}  // namespace
+
+TEST(reader_parses_driver_order_json) {
+  reader::Record record;
+  CHECK(reader::parse(R"({"ts":"2020-01-02T03:04:05Z","level":"INFO","msg":"hi","k":"v","n":3})",
+                      reader::Format::JSON, record));
+  CHECK(record.ts == "2020-01-02T03:04:05Z");
+  CHECK(record.level == "INFO");
+  CHECK(record.msg == "hi");
+  CHECK(fields(record) == (std::vector<std::string>{"k=v*", "n=3"}));
+  CHECK(record.get("n") == "3");
+  CHECK(record.get("missing").empty());
+  CHECK(reader::timestamp(record.line, reader::Format::JSON) == "2020-01-02T03:04:05Z");
+}
+
+TEST(reader_parses_json_in_any_key_order) {
+  reader::Record record;
+  std::string line = R"({"msg":"hi","k":"v","level":"WARN","ts":"2020-01-02T03:04:05Z"})";
+  CHECK(reader::parse(line, reader::Format::JSON, record));
+  CHECK(record.ts == "2020-01-02T03:04:05Z");
+  CHECK(record.level == "WARN");
+  CHECK(record.msg == "hi");
+  CHECK(record.get("k") == "v");
+  CHECK(reader::timestamp(line, reader::Format::JSON) == "2020-01-02T03:04:05Z");
+  CHECK(!reader::parse("not json", reader::Format::JSON, record));
+}
+
+TEST(reader_skips_escaped_quotes_and_nested_values) {
+  reader::Record record;
+  CHECK(reader::parse(
+      R"({"ts":"t","level":"INFO","msg":"say \"}\"","a\"b":"x\\","obj":{"s":"}]","l":[1,{"m":2}]},"n":-1})",
+      reader::Format::JSON, record));
+  CHECK(record.msg == R"(say \"}\")");
+  CHECK(reader::unescape(record.msg) == "say \"}\"");
+  CHECK(fields(record) ==
+        (std::vector<std::string>{R"(a\"b=x\\*)", R"(obj={"s":"}]","l":[1,{"m":2}]})", "n=-1"}));
+}
+
+TEST(reader_parses_console_lines) {
+  reader::Record record;
+  std::string line = "2020-01-02T03:04:05Z\t\e[31mERROR\e[0m\tfailed\tcode: 7, path: /a b";
+  CHECK(reader::parse(line, reader::Format::CONSOLE, record));
+  CHECK(record.ts == "2020-01-02T03:04:05Z");
+  CHECK(record.level == "ERROR");
+  CHECK(record.msg == "failed");
+  CHECK(fields(record) == (std::vector<std::string>{"code=7", "path=/a b"}));
+  CHECK(reader::timestamp(line, reader::Format::CONSOLE) == "2020-01-02T03:04:05Z");
+  CHECK(reader::parse("2020-01-02T03:04:05Z\tINFO\tplain", reader::Format::CONSOLE, record));
+  CHECK(record.msg == "plain" && record.fields.empty());
+  CHECK(!reader::parse("no tabs", reader::Format::CONSOLE, record));
+}
+
+TEST(reader_unescapes_json_strings) {
+  CHECK(reader::unescape(R"(a\nb\t\"c\"\\)") == "a\nb\t\"c\"\\");
+  CHECK(reader::unescape(R"(\u00e9\u20AC)") == "\xc3\xa9\xe2\x82\xac");
+  // a code point past the basic plane is a surrogate pair
+  CHECK(reader::unescape(R"(\ud83d\ude00!)") == "\xf0\x9f\x98\x80!");
+  // a high surrogate without its low half is encoded on its own
+  CHECK(reader::unescape(R"(\ud83dx)") == "\xed\xa0\xbdx");
+  CHECK(reader::unescape(R"(\u12)") == "");
+}
+
+TEST(reader_splits_on_line_boundaries) {
+  std::string data = "one\ntwo\nthree\nfour\nfive";
+  for (std::size_t parts : {1, 2, 3, 5, 50}) {
+    std::vector<std::string_view> ranges = reader::split(data, parts);
+    CHECK(!ranges.empty() && ranges.size() <= parts);
+    std::string joined;
+    for (std::size_t i = 0; i < ranges.size(); i++) {
+      CHECK(!ranges[i].empty());
+      CHECK(i + 1 == ranges.size() || ranges[i].back() == '\n');
+      joined += ranges[i];
+    }
+    CHECK(joined == data);
+  }
+  CHECK(reader::split("", 4).empty());
+  CHECK(reader::split("single line", 4).size() == 1);
+}
+
+TEST(merge_keeps_input_order_and_continuations) {
+  std::string a = temporary_path(), b = temporary_path(), merged = temporary_path();
+  std::ofstream(a) << R"({"ts":"2020-01-01T00:00:01Z","level":"INFO","msg":"a1"})" "\n"
+                   << R"({"ts":"2020-01-01T00:00:02Z","level":"INFO","msg":"a2"})" "\n"
+                   << "  a2 continued\n";
+  std::ofstream(b) << R"({"ts":"2020-01-01T00:00:01Z","level":"INFO","msg":"b1"})" "\n"
+                   << "  b1 continued\n"
+                   << R"({"ts":"2020-01-01T00:00:02Z","level":"INFO","msg":"b2"})" "\n"
+                   << R"({"ts":"2020-01-01T00:00:03Z","level":"INFO","msg":"b3"})" "\n";
+  pid_t child = fork();
+  if (child == 0) {
+    execl("bin/ptclogs-merge", "ptclogs-merge", "-o", merged.c_str(), a.c_str(), b.c_str(),
+          (char*)nullptr);
+    _exit(127);
+  }
+  int status = -1;
+  waitpid(child, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  std::vector<std::string> order;
+  reader::for_each_line(read_file(merged), [&](std::string_view line) {
+    reader::Record record;
+    order.push_back(reader::parse(line, reader::Format::JSON, record) ? std::string(record.msg)
+                                                                      : std::string(line));
+  });
+  CHECK(order == (std::vector<std::string>{"a1", "b1", "  b1 continued", "a2", "  a2 continued",
+                                           "b2", "b3"}));
+  unlink(a.c_str());
+  unlink(b.c_str());
+  unlink(merged.c_str());
+}
+
+int main() { return check::run_tests(); }
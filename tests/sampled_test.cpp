@@ -0,0 +1,93 @@
+#include <ptclogs/driver/json_driver.hpp>
+#include <ptclogs/logs.hpp>
+#include <ptclogs/memory.hpp>
+#include <ptclogs/sampled.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::stringbuf written;
+std::ostream output(&written);
+Logger<JSONDriver, output> parent(LogLevel::INFO);
+}  // namespace
+
+TEST(sampled_keeps_text_of_held_back_records) {
+  written.str("");
+  {
+    auto req = parent.Sampled({}, Field<int>("request", 1));
+    char message[32], key[32], text[32];
+    strcpy(message, "cache miss");
+    strcpy(key, "user:42");
+    strcpy(text, "slow path");
+    req.DEBUG(std::string_view(message), Field<std::string_view>("key", key),
+              Field<const char*>("path", text));
+    // the caller's buffers are reused before the records are written
+    strcpy(message, "overwritten");
+    strcpy(key, "overwritten");
+    strcpy(text, "overwritten");
+    req.ERROR("upstream failed");
+  }
+  std::string text = written.str();
+  CHECK(check::count(text, "\"msg\":\"cache miss\"") == 1);
+  CHECK(check::count(text, "\"key\":\"user:42\"") == 1);
+  CHECK(check::count(text, "\"path\":\"slow path\"") == 1);
+  CHECK(check::count(text, "overwritten") == 0);
+  CHECK(text.find("upstream failed") < text.find("cache miss"));
+}
+
+TEST(sampled_drops_uninteresting_requests) {
+  written.str("");
+  {
+    auto req = parent.Sampled({}, Field<int>("request", 2));
+    req.DEBUG("cache miss", Field<std::string>("key", "user:42"));
+    req.INFO("served");
+  }
+  CHECK(check::count(written.str(), "\n") == 1);
+  CHECK(check::count(written.str(), "cache miss") == 0);
+}
+
+TEST(sampled_formats_held_back_messages_when_written) {
+  written.str("");
+  {
+    auto req = parent.Sampled({}, Field<int>("request", 3));
+    char key[32];
+    strcpy(key, "user:42");
+    req.DEBUG("cache miss for {} after {} tries", std::string_view(key), 3,
+              Field<int>("shard", 7));
+    strcpy(key, "overwritten");
+    req.ERROR("upstream {} failed", "db");
+  }
+  std::string text = written.str();
+  CHECK(check::count(text, "\"msg\":\"cache miss for user:42 after 3 tries\"") == 1);
+  CHECK(check::count(text, "\"shard\":7") == 1);
+  CHECK(check::count(text, "upstream db failed") == 1);
+  CHECK(check::count(text, "overwritten") == 0);
+}
+
+TEST(sampled_keeps_text_of_char_buffers) {
+  written.str("");
+  {
+    auto req = parent.Sampled({}, Field<int>("request", 4));
+    char buf[32];
+    strcpy(buf, "alice");
+    req.DEBUG("name {}", buf);
+    req.DEBUG(buf);
+    req.DEBUG("field", Field<char*>("k", buf));
+    // the caller's buffer is reused before the records are written
+    strcpy(buf, "CLOBBERED");
+    req.ERROR("upstream failed");
+  }
+  std::string text = written.str();
+  CHECK(check::count(text, "\"msg\":\"name alice\"") == 1);
+  CHECK(check::count(text, "\"msg\":\"alice\"") == 1);
+  CHECK(check::count(text, "\"k\":\"alice\"") == 1);
+  CHECK(check::count(text, "CLOBBERED") == 0);
+}
+
+int main() { return check::run_tests(); }
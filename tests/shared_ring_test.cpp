@@ -0,0 +1,80 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ptclogs/sink/shared_ring.hpp>
+
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::thread read_all(int fd, std::string& text) {
+  return std::thread([fd, &text] {
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof buf)) > 0) text.append(buf, n);
+  });
+}
+}  // namespace
+
+TEST(shared_ring_merges_workers_reports_drops) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  std::thread reader = read_all(fds[0], text);
+  {
+    SharedRingBuffer ring(8, 4096);
+    std::ostream stream(&ring);
+    ring.drain_to(fds[1], std::chrono::microseconds(200));
+    for (int w = 0; w < 3; w++) {
+      if (fork() == 0) {
+        for (int i = 0; i < 100; i++) stream << "worker " << w << " record " << i << '\n' << std::flush;
+        // larger than half a lane
+        stream << std::string(3000, 'x') << '\n' << std::flush;
+        _exit(0);
+      }
+    }
+    for (int w = 0; w < 3; w++) wait(nullptr);
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+  CHECK(check::count(text, " record ") == 300);
+  CHECK(check::count(text, "xxx") == 0);
+  CHECK(check::count(text, "log records dropped under backpressure") >= 1);
+  std::size_t dropped = 0;
+  for (auto at = text.find("\"dropped_info\":"); at != text.npos;
+       at = text.find("\"dropped_info\":", at + 1))
+    dropped += std::stoul(text.substr(at + 15));
+  CHECK(dropped == 3);
+}
+
+TEST(shared_ring_frees_lanes_of_dead_processes) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  std::thread reader = read_all(fds[0], text);
+  {
+    // a single lane, which the parent only gets once the child's is freed
+    SharedRingBuffer ring(1, 4096);
+    std::ostream stream(&ring);
+    ring.drain_to(fds[1], std::chrono::microseconds(200));
+    pid_t child = fork();
+    if (child == 0) {
+      stream << "child\n" << std::flush;
+      _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+    stream << "parent\n" << std::flush;
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+  CHECK(text == "child\nparent\n");
+}
+
+int main() { return check::run_tests(); }
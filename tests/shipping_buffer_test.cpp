@@ -0,0 +1,144 @@
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ptclogs/sink/shipping_buffer.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+std::string temporary_path(const char* name) {
+  return "/tmp/ptclogs-" + std::to_string(getpid()) + "-" + name;
+}
+
+/**
+ * @brief Runs bin/ptclogs-collect, the stand-in collector, until destroyed.
+ */
+class Collector {
+ public:
+  Collector(const std::string& socket, const std::string& output) {
+    pid = fork();
+    if (pid == 0) {
+      execl("bin/ptclogs-collect", "ptclogs-collect", "-o", output.c_str(),
+            ("unix:" + socket).c_str(), (char*)nullptr);
+      _exit(127);
+    }
+    // listening once the socket exists
+    for (int i = 0; i < 500 && access(socket.c_str(), F_OK) != 0; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  ~Collector() {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+  }
+
+ private:
+  pid_t pid;
+};
+
+std::string read_file(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream text;
+  text << in.rdbuf();
+  return text.str();
+}
+
+/**
+ * @brief Waits up to 5s for path to hold lines lines.
+ */
+std::string wait_for_lines(const std::string& path, std::size_t lines) {
+  std::string text;
+  for (int i = 0; i < 500; i++) {
+    text = read_file(path);
+    if (check::count(text, "\n") >= lines) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return text;
+}
+
+/**
+ * @brief Returns whether records from to to - 1 are in text exactly once.
+ */
+bool each_once(const std::string& text, int from, int to) {
+  bool once = true;
+  for (int i = from; i < to; i++)
+    once &= check::count(text, "record " + std::to_string(i) + "\n") == 1;
+  return once;
+}
+}  // namespace
+
+TEST(shipping_buffer_delivers_every_record_once) {
+  std::string socket = temporary_path("collect.sock"), output = temporary_path("collected");
+  Collector collector(socket, output);
+  {
+    ShippingOptions options;
+    options.frame_bytes = 256;
+    ShippingBuffer buffer("unix:" + socket, options);
+    std::ostream stream(&buffer);
+    for (int i = 0; i < 2000; i++) stream << "record " << i << '\n' << std::flush;
+  }
+  std::string text = wait_for_lines(output, 2000);
+  CHECK(check::count(text, "\n") == 2000);
+  CHECK(each_once(text, 0, 2000));
+  unlink(output.c_str());
+  unlink(socket.c_str());
+}
+
+TEST(shipping_buffer_replays_spool_once_collector_is_back) {
+  std::string socket = temporary_path("collect.sock"), output = temporary_path("collected");
+  std::string spool = temporary_path("spool");
+  {
+    ShippingOptions options;
+    options.frame_bytes = 256;
+    options.min_backoff = std::chrono::milliseconds(10);
+    options.max_backoff = std::chrono::milliseconds(20);
+    options.spool = spool;
+    ShippingBuffer buffer("unix:" + socket, options);
+    std::ostream stream(&buffer);
+    {
+      Collector collector(socket, output);
+      for (int i = 0; i < 500; i++) stream << "record " << i << '\n' << std::flush;
+      wait_for_lines(output, 500);
+    }
+    // down: these go to the spool
+    for (int i = 500; i < 1000; i++) stream << "record " << i << '\n' << std::flush;
+    for (int i = 0; i < 500 && buffer.pending(); i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(buffer.spooled() > 0);
+    Collector collector(socket, output);
+    for (int i = 0; i < 500 && buffer.spooled(); i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(buffer.spooled() == 0);
+    std::string text = wait_for_lines(output, 1000);
+    CHECK(check::count(text, "\n") == 1000);
+    CHECK(each_once(text, 0, 1000));
+  }
+  unlink(output.c_str());
+  unlink(socket.c_str());
+  unlink(spool.c_str());
+}
+
+TEST(shipping_buffer_stops_without_collector) {
+  ShippingOptions options;
+  options.timeout = std::chrono::milliseconds(50);
+  auto started = std::chrono::steady_clock::now();
+  {
+    ShippingBuffer buffer("unix:" + temporary_path("nobody.sock"), options);
+    std::ostream stream(&buffer);
+    for (int i = 0; i < 100; i++) stream << "record " << i << '\n' << std::flush;
+  }
+  // what couldn't be sent is dropped instead of holding up the exit
+  CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(2));
+}
+
+int main() { return check::run_tests(); }
@@ -0,0 +1,197 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <ptclogs/driver/json_driver.hpp>
+#include <ptclogs/logs.hpp>
+#include <ptclogs/sink/async_buffer.hpp>
+#include <ptclogs/sink/fd_buffer.hpp>
+#include <ptclogs/sink/overflow.hpp>
+#include <ptclogs/sink/record_buffer.hpp>
+
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace logger;
+
+namespace {
+/**
+ * @brief Keeps every committed record.
+ */
+class CaptureBuffer : public RecordBuffer {
+ public:
+  std::vector<std::string> records;
+
+ protected:
+  void commit(LogLevel, const char* data, std::size_t size) override {
+    records.emplace_back(data, size);
+  }
+};
+
+/**
+ * @brief Reads whatever is buffered in a pipe without blocking.
+ */
+std::string drain_pipe(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  std::string text;
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof buf)) > 0) text.append(buf, n);
+  return text;
+}
+
+CaptureBuffer outer_buffer, inner_buffer;
+std::ostream outer_stream(&outer_buffer), inner_stream(&inner_buffer);
+Logger<JSONDriver, inner_stream> inner(LogLevel::INFO);
+
+/**
+ * @brief Logs to another logger while it is being formatted.
+ */
+struct Noisy {
+  friend std::ostream& operator<<(std::ostream& os, const Noisy&) {
+    inner.INFO("inner record");
+    return os << "noisy";
+  }
+};
+}  // namespace
+
+TEST(shed_by_level_admits_large_record_into_empty_queue) {
+  RecordQueue queue(OverflowPolicy{OverflowMode::SHED_BY_LEVEL, 100});
+  CHECK(queue.admit(LogLevel::DEBUG, 80) == RecordQueue::ADMIT);
+  CHECK(queue.admit(LogLevel::INFO, 90) == RecordQueue::ADMIT);
+}
+
+TEST(shed_by_level_refuses_debug_above_threshold) {
+  RecordQueue queue(OverflowPolicy{OverflowMode::SHED_BY_LEVEL, 100});
+  std::string record(60, 'x');
+  queue.push(LogLevel::ERROR, record.data(), record.size());
+  CHECK(queue.admit(LogLevel::DEBUG, 10) == RecordQueue::DROP);
+  CHECK(queue.admit(LogLevel::INFO, 10) == RecordQueue::ADMIT);
+  CHECK(queue.admit(LogLevel::ERROR, 50) == RecordQueue::WAIT);
+}
+
+TEST(drop_oldest_evicts_pending_records) {
+  RecordQueue queue(OverflowPolicy{OverflowMode::DROP_OLDEST, 100});
+  std::string record(40, 'x');
+  for (int i = 0; i < 2; i++) queue.push(LogLevel::INFO, record.data(), record.size());
+  queue.push(LogLevel::DEBUG, "y", 1);
+  CHECK(queue.admit(LogLevel::INFO, 40) == RecordQueue::ADMIT);
+  DropCounts counts;
+  CHECK(queue.take_drops(counts));
+  CHECK(counts[LogLevel::INFO] + counts[LogLevel::DEBUG] == 1);
+}
+
+TEST(nested_records_are_staged_apart) {
+  Logger<JSONDriver, outer_stream> outer(LogLevel::INFO);
+  outer.INFO("outer record", Field("value", Noisy()));
+  CHECK(outer_buffer.records.size() == 1);
+  CHECK(inner_buffer.records.size() == 1);
+  CHECK(check::count(outer_buffer.records[0], "outer record") == 1);
+  CHECK(check::count(outer_buffer.records[0], "inner record") == 0);
+  CHECK(check::count(inner_buffer.records[0], "inner record") == 1);
+  CHECK(check::count(inner_buffer.records[0], "\n") == 1);
+}
+
+TEST(fd_buffer_writes_records_in_order) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  {
+    FdBuffer buffer(fds[1]);
+    std::ostream stream(&buffer);
+    for (int i = 0; i < 100; i++) stream << "record " << i << '\n' << std::flush;
+  }
+  text = drain_pipe(fds[0]);
+  close(fds[0]);
+  close(fds[1]);
+  CHECK(check::count(text, "\n") == 100);
+  CHECK(text.find("record 0\n") < text.find("record 99\n"));
+}
+
+TEST(fd_buffer_reports_drops_once_drained) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  std::string text;
+  {
+    FdBuffer buffer(fds[1], OverflowPolicy{OverflowMode::DROP_NEWEST, 4096});
+    std::ostream stream(&buffer);
+    std::string record(1000, 'x');
+    // more than the pipe and the overflow buffer hold together
+    for (int i = 0; i < 200; i++) stream << record << '\n' << std::flush;
+    text = drain_pipe(fds[0]);
+    stream << "after\n" << std::flush;
+  }
+  text += drain_pipe(fds[0]);
+  close(fds[0]);
+  close(fds[1]);
+  CHECK(check::count(text, "log records dropped under backpressure") == 1);
+  CHECK(check::count(text, "after\n") == 1);
+}
+
+TEST(fd_buffer_counts_failed_writes_as_drops) {
+  // writes to a read only descriptor fail with EBADF
+  int fd = open("/dev/null", O_RDONLY);
+  DropCounts reported{};
+  {
+    FdBuffer buffer(fd, OverflowPolicy(), [&](const DropCounts& counts) {
+      for (int i = 0; i < 5; i++) reported[i] += counts[i];
+      return std::string("report\n");
+    });
+    std::ostream stream(&buffer);
+    stream << "lost\n" << std::flush;
+  }
+  close(fd);
+  CHECK(reported[LogLevel::INFO] == 1);
+}
+
+TEST(async_buffer_writes_every_record) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  {
+    AsyncBuffer buffer(fds[1]);
+    std::ostream stream(&buffer);
+    for (int i = 0; i < 1000; i++) stream << "record " << i << '\n' << std::flush;
+  }
+  std::string text = drain_pipe(fds[0]);
+  close(fds[0]);
+  close(fds[1]);
+  CHECK(check::count(text, "\n") == 1000);
+  CHECK(text.rfind("record 999\n") == text.size() - 11);
+}
+
+TEST(async_buffer_reports_drops_once_drained) {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  // fill the pipe, so the writer blocks and the queue overflows
+  fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+  std::string junk(4096, '-');
+  while (write(fds[1], junk.data(), junk.size()) > 0) {
+  }
+  fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) & ~O_NONBLOCK);
+  std::string text;
+  std::thread reader;
+  {
+    AsyncBuffer buffer(fds[1], OverflowPolicy{OverflowMode::DROP_NEWEST, 1024});
+    std::ostream stream(&buffer);
+    std::string record(100, 'x');
+    for (int i = 0; i < 100; i++) stream << record << '\n' << std::flush;
+    reader = std::thread([&] {
+      char buf[4096];
+      ssize_t n;
+      while ((n = read(fds[0], buf, sizeof buf)) > 0) text.append(buf, n);
+    });
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+  std::size_t reported_at = text.find("log records dropped under backpressure");
+  CHECK(reported_at != text.npos);
+  // the records queued before the drops come first
+  CHECK(reported_at > text.rfind(std::string(100, 'x')));
+  CHECK(check::count(text, "log records dropped under backpressure") == 1);
+}
+
+int main() { return check::run_tests(); }
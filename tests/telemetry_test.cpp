@@ -0,0 +1,27 @@
+#include <ptclogs/telemetry.hpp>
+
+#include <string>
+
+#include "check.hpp"
+
+using namespace logger;
+
+TEST(prometheus_folds_latency_into_coarse_buckets) {
+  telemetry::Snapshot s;
+  s.latency[LogLevel::INFO].counts[telemetry::bucket(1500)] = 3;
+  s.latency[LogLevel::INFO].counts[telemetry::bucket(4095)] = 1;
+  s.latency[LogLevel::INFO].counts[telemetry::bucket(4096)] = 1;
+  s.latency_ns[LogLevel::INFO] = 3 * 1500 + 4095 + 4096;
+  std::string text = telemetry::to_prometheus(s);
+  CHECK(check::count(text, "ptclogs_call_seconds_bucket{") == 5 * 14);
+  CHECK(check::count(text, "{level=\"info\",le=\"0.000001024\"} 0\n") == 1);
+  CHECK(check::count(text, "{level=\"info\",le=\"0.000004096\"} 4\n") == 1);
+  CHECK(check::count(text, "{level=\"info\",le=\"0.000016384\"} 5\n") == 1);
+  CHECK(check::count(text, "{level=\"info\",le=\"17.179869184\"} 5\n") == 1);
+  CHECK(check::count(text, "{level=\"info\",le=\"+Inf\"} 5\n") == 1);
+  // the sum is what was recorded, not the bucket bounds
+  CHECK(check::count(text, "ptclogs_call_seconds_sum{level=\"info\"} 0.000012691\n") == 1);
+  CHECK(check::count(text, "ptclogs_call_seconds_count{level=\"info\"} 5\n") == 1);
+}
+
+int main() { return check::run_tests(); }
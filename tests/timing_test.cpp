@@ -0,0 +1,43 @@
+#include <ptclogs/timing.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace logger;
+
+TEST(latency_summary_thread_outlives_summaries) {
+  // a thread outliving many summaries records into each new one on its own
+  std::uint64_t emitted = 0, wrong = 0;
+  for (int i = 0; i < 200; i++) {
+    LatencySummary summary(
+        [&](const std::string&, const telemetry::Histogram& period) {
+          emitted += period.count();
+          wrong += period.count() != 3;
+        },
+        std::chrono::hours(1));
+    LatencySeries series = summary.series("op");
+    for (int j = 0; j < 3; j++) series.record(1000);
+  }
+  CHECK(emitted == 600);
+  CHECK(wrong == 0);
+}
+
+TEST(latency_summary_folds_exited_threads) {
+  std::uint64_t emitted = 0;
+  {
+    LatencySummary summary(
+        [&](const std::string&, const telemetry::Histogram& period) { emitted += period.count(); },
+        std::chrono::hours(1));
+    LatencySeries series = summary.series("op");
+    std::thread([&] { series.record(1000); }).join();
+    summary.emit_now();
+    CHECK(emitted == 1);
+    series.record(1000);
+  }
+  CHECK(emitted == 2);
+}
+
+int main() { return check::run_tests(); }
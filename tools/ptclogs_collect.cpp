@@ -0,0 +1,143 @@
+/**
+ * ptclogs-collect: minimal collector for ShippingBuffer, which receives the
+ * frames of any number of processes and writes their records out.
+ *
+ * usage: ptclogs-collect [-o OUTPUT] ADDRESS
+ *
+ * ADDRESS is unix:PATH or tcp:HOST:PORT, as given to ShippingBuffer. Each
+ * frame is written whole, so records of different processes never
+ * interleave. Meant as a stand-in for a node agent and for testing.
+ */
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+struct Client {
+    int fd;
+    std::string pending;
+};
+
+int listen_on(const std::string& address) {
+    int fd = -1;
+    if (address.compare(0, 5, "unix:") == 0) {
+	sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	std::string path = address.substr(5);
+	if (path.size() >= sizeof addr.sun_path) return -1;
+	memcpy(addr.sun_path, path.data(), path.size());
+	unlink(path.c_str());
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) return -1;
+    } else if (address.compare(0, 4, "tcp:") == 0) {
+	std::size_t colon = address.rfind(':');
+	if (colon <= 4) return -1;
+	std::string host = address.substr(4, colon - 4);
+	if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+	    host = host.substr(1, host.size() - 2);
+	addrinfo hints{};
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+	addrinfo* found = nullptr;
+	if (getaddrinfo(host.empty() ? nullptr : host.c_str(), address.c_str() + colon + 1,
+			&hints, &found) != 0)
+	    return -1;
+	fd = socket(found->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	int one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+	bool bound = fd >= 0 && bind(fd, found->ai_addr, found->ai_addrlen) == 0;
+	freeaddrinfo(found);
+	if (!bound) return -1;
+    } else {
+	return -1;
+    }
+    return listen(fd, 64) == 0 ? fd : -1;
+}
+
+/**
+ * @brief Writes out the complete frames received from a client.
+ */
+void write_frames(Client& client, FILE* out) {
+    std::size_t at = 0;
+    while (client.pending.size() - at >= 4) {
+	auto* header = reinterpret_cast<const unsigned char*>(client.pending.data() + at);
+	std::uint32_t length = std::uint32_t(header[0]) << 24 | std::uint32_t(header[1]) << 16 |
+			       std::uint32_t(header[2]) << 8 | header[3];
+	if (client.pending.size() - at - 4 < length) break;
+	fwrite(client.pending.data() + at + 4, 1, length, out);
+	at += 4 + length;
+    }
+    client.pending.erase(0, at);
+    fflush(out);
+}
+
+int usage() {
+    fprintf(stderr, "usage: ptclogs-collect [-o OUTPUT] ADDRESS\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    FILE* out = stdout;
+    const char* address = nullptr;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	if (arg == "-o" && i + 1 < argc) {
+	    out = fopen(argv[++i], "a");
+	    if (!out) {
+		perror(argv[i]);
+		return 1;
+	    }
+	} else if (!address) {
+	    address = argv[i];
+	} else {
+	    return usage();
+	}
+    }
+    if (!address) return usage();
+    int listener = listen_on(address);
+    if (listener < 0) {
+	perror(address);
+	return 1;
+    }
+
+    std::vector<Client> clients;
+    std::vector<pollfd> polled;
+    char buf[1 << 16];
+    while (true) {
+	polled.assign(1, pollfd{listener, POLLIN, 0});
+	for (auto& c : clients) polled.push_back(pollfd{c.fd, POLLIN, 0});
+	if (poll(polled.data(), polled.size(), -1) < 0) {
+	    if (errno == EINTR) continue;
+	    perror("poll");
+	    return 1;
+	}
+	// clients first, accepting may grow the list
+	for (std::size_t i = clients.size(); i-- > 0;) {
+	    if (!polled[i + 1].revents) continue;
+	    ssize_t n = read(clients[i].fd, buf, sizeof buf);
+	    if (n > 0) {
+		clients[i].pending.append(buf, n);
+		write_frames(clients[i], out);
+	    } else if (n == 0 || errno != EINTR) {
+		// a cut frame of a client that went away is dropped
+		close(clients[i].fd);
+		clients.erase(clients.begin() + i);
+	    }
+	}
+	if (polled[0].revents) {
+	    int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+	    if (fd >= 0) clients.push_back(Client{fd, std::string()});
+	}
+    }
+}
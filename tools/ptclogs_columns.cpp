@@ -0,0 +1,249 @@
+/**
+ * ptclogs-columns: reads columnar segments written by ColumnarFileBuffer.
+ *
+ * usage: ptclogs-columns [--select KEY,...] [--blocks] [--stats] FILE...
+ *
+ * By default every record is printed back as a JSON line, in the order the
+ * records were committed: the blocks of all files are merged by commit time,
+ * which holds the output in memory. --blocks prints block by block instead,
+ * as the blocks are read. --select prints only the given columns, tab
+ * separated, decoding nothing else; any key is a column, a key a block
+ * doesn't have is left empty, and keys the records don't have name the
+ * commit time, printed with nanoseconds, as time, and the level as level. ts
+ * falls back to the commit time for records that had no ts field. --stats
+ * prints how many bytes each column takes and how it is encoded.
+ */
+#include <time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ptclogs/columnar.hpp"
+#include "ptclogs/reader.hpp"
+
+namespace {
+using namespace logger::columnar;
+
+std::string format_time(std::int64_t ns, bool fraction) {
+    time_t seconds = ns / 1000000000;
+    tm utc;
+    gmtime_r(&seconds, &utc);
+    char buf[64];
+    std::size_t n = strftime(buf, sizeof buf, "%FT%T", &utc);
+    if (fraction) n += snprintf(buf + n, sizeof buf - n, ".%09lld", (long long)(ns % 1000000000));
+    buf[n++] = 'Z';
+    return std::string(buf, n);
+}
+
+struct Decoded {
+    std::vector<std::string_view> values;
+    std::vector<std::string> storage;
+    bool quoted = false;
+};
+
+/**
+ * @brief A printed record: its commit time and where its text is in the
+ * output.
+ */
+struct Line {
+    std::int64_t ns;
+    std::size_t begin, end;
+};
+
+/**
+ * @brief Notes the line of a record printed from begin on, when merging.
+ */
+void add_line(std::vector<Line>* lines, std::int64_t ns, std::size_t& begin,
+	      const std::string& out) {
+    if (lines) lines->push_back(Line{ns, begin, out.size()});
+    begin = out.size();
+}
+
+/**
+ * @brief Prints the records of a block as JSON lines, with their own ts, or
+ * their commit time when they had none.
+ */
+bool print_records(const Block& block, std::string& out, std::vector<Line>* lines) {
+    std::vector<std::int64_t> ts;
+    std::vector<logger::LogLevel> levels;
+    if (!block.timestamps(ts) || !block.levels(levels)) return false;
+    std::vector<Decoded> columns(block.columns.size());
+    for (std::size_t c = 0; c < columns.size(); c++)
+	if (!block.columns[c].values(block.records, columns[c].values, columns[c].storage,
+				     columns[c].quoted))
+	    return false;
+
+    auto value = [&](std::size_t c, std::size_t i) {
+	if (columns[c].quoted) out += '"';
+	out += columns[c].values[i];
+	if (columns[c].quoted) out += '"';
+    };
+    // JSONDriver writes ts first, blocks without it are from older writers
+    bool own_ts = !columns.empty() && block.columns[0].key == "ts";
+    std::size_t begin = out.size();
+    for (std::size_t i = 0; i < block.records; i++) {
+	if (block.flags & VERBATIM) {
+	    (out += columns[0].values[i]) += '\n';
+	} else {
+	    out += "{\"ts\":";
+	    if (own_ts)
+		value(0, i);
+	    else
+		((out += '"') += format_time(ts[i], false)) += '"';
+	    ((out += ",\"level\":\"") += logger::level_name(levels[i])) += '"';
+	    for (std::size_t c = own_ts; c < columns.size(); c++) {
+		((out += ",\"") += block.columns[c].key) += "\":";
+		value(c, i);
+	    }
+	    out += "}\n";
+	}
+	add_line(lines, ts[i], begin, out);
+    }
+    return true;
+}
+
+/**
+ * @brief Prints the selected columns of a block, tab separated.
+ */
+bool print_columns(const Block& block, const std::vector<std::string>& keys, std::string& out,
+		   std::vector<Line>* lines) {
+    std::vector<std::int64_t> ts;
+    std::vector<logger::LogLevel> levels;
+    std::vector<Decoded> columns(keys.size());
+    std::vector<const Column*> found(keys.size());
+    for (std::size_t k = 0; k < keys.size(); k++) {
+	if ((found[k] = block.find(keys[k]))) {
+	    if (!found[k]->values(block.records, columns[k].values, columns[k].storage,
+				  columns[k].quoted))
+		return false;
+	} else if (keys[k] == "level") {
+	    if (levels.empty() && !block.levels(levels)) return false;
+	}
+    }
+    if (!block.timestamps(ts)) return false;
+
+    std::size_t begin = out.size();
+    for (std::size_t i = 0; i < block.records; i++) {
+	for (std::size_t k = 0; k < keys.size(); k++) {
+	    if (k) out += '\t';
+	    if (found[k])
+		out += columns[k].values[i];
+	    else if (keys[k] == "ts" || keys[k] == "time")
+		out += format_time(ts[i], true);
+	    else if (keys[k] == "level")
+		out += logger::level_name(levels[i]);
+	}
+	out += '\n';
+	add_line(lines, ts[i], begin, out);
+    }
+    return true;
+}
+
+struct Usage {
+    std::size_t bytes = 0;
+    std::map<std::string, std::size_t> encodings;
+};
+
+void count_columns(const Block& block, std::map<std::string, Usage>& usage) {
+    static const char* names[] = {"?", "int", "dict", "raw"};
+    usage["ts"].bytes += block.ts.data.size();
+    usage["ts"].encodings["delta"] += block.records;
+    usage["level"].bytes += block.level.data.size();
+    usage["level"].encodings["packed"] += block.records;
+    for (auto& column : block.columns) {
+	Usage& u = usage[std::string(column.key)];
+	u.bytes += column.data.size();
+	std::uint8_t encoding = column.data.empty() ? 0 : column.data[0] & ~QUOTED;
+	u.encodings[names[encoding <= RAW ? encoding : 0]] += block.records;
+    }
+}
+
+int usage() {
+    fprintf(stderr, "usage: ptclogs-columns [--select KEY,...] [--blocks] [--stats] FILE...\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> select;
+    bool stats = false, blocks = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	if (arg == "--select" && i + 1 < argc) {
+	    std::string_view list = argv[++i];
+	    for (std::size_t comma = 0; comma != std::string_view::npos; list.remove_prefix(comma + 1)) {
+		comma = list.find(',');
+		select.emplace_back(list.substr(0, comma));
+	    }
+	} else if (arg == "--stats") {
+	    stats = true;
+	} else if (arg == "--blocks") {
+	    blocks = true;
+	} else if (arg[0] == '-' && arg.size() > 1) {
+	    return usage();
+	} else {
+	    paths.push_back(argv[i]);
+	}
+    }
+    if (paths.empty()) return usage();
+
+    std::map<std::string, Usage> columns;
+    std::size_t records = 0, size = 0;
+    std::string out;
+    std::vector<Line> lines;
+    std::vector<Line>* merged = blocks ? nullptr : &lines;
+    int status = 0;
+    for (const char* path : paths) {
+	logger::reader::MappedFile file;
+	if (!file.open(path)) {
+	    perror(path);
+	    return 1;
+	}
+	size += file.data().size();
+	bool ok = for_each_block(file.data(), [&](const Block& block) {
+	    records += block.records;
+	    if (stats)
+		count_columns(block, columns);
+	    else if (!(select.empty() ? print_records(block, out, merged)
+				      : print_columns(block, select, out, merged)))
+		status = 1;
+	    if (blocks && out.size() >= 1 << 20) {
+		fwrite(out.data(), 1, out.size(), stdout);
+		out.clear();
+	    }
+	});
+	if (!ok) {
+	    fprintf(stderr, "%s: not a well formed segment\n", path);
+	    status = 1;
+	}
+    }
+    if (merged) {
+	std::stable_sort(lines.begin(), lines.end(),
+			 [](const Line& a, const Line& b) { return a.ns < b.ns; });
+	std::string sorted;
+	for (auto& line : lines) {
+	    sorted.append(out, line.begin, line.end - line.begin);
+	    if (sorted.size() >= 1 << 20) {
+		fwrite(sorted.data(), 1, sorted.size(), stdout);
+		sorted.clear();
+	    }
+	}
+	out.swap(sorted);
+    }
+    fwrite(out.data(), 1, out.size(), stdout);
+
+    if (stats) {
+	printf("%zu records in %zu bytes, %.1f bytes per record\n", records, size,
+	       records ? double(size) / records : 0.0);
+	for (auto& [key, u] : columns) {
+	    printf("%-24s %12zu bytes", key.c_str(), u.bytes);
+	    for (auto& [encoding, count] : u.encodings) printf("  %s:%zu", encoding.c_str(), count);
+	    printf("\n");
+	}
+    }
+    return status;
+}
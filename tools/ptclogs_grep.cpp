@@ -0,0 +1,110 @@
+/**
+ * ptclogs-grep: prints the records of ptclogs files whose message contains
+ * PATTERN, optionally filtered by level and field value.
+ *
+ * usage: ptclogs-grep [--level LEVEL] [--field KEY=VALUE] [--threads N]
+ *                     [--count] PATTERN FILE...
+ *
+ * LEVEL selects records at that level or more severe. Files are scanned in
+ * parallel windows and matches are printed in file order.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ptclogs/reader.hpp"
+
+namespace {
+struct Query {
+    std::string pattern;
+    unsigned levels = ~0u;
+    std::string key;
+    std::string value;
+};
+
+bool matches(const Query& q, const logger::reader::Record& record) {
+    logger::LogLevel level;
+    if (q.levels != ~0u && (!record.level_value(level) || !(q.levels >> level & 1)))
+	return false;
+    if (record.msg.find(q.pattern) == std::string_view::npos) return false;
+    return q.key.empty() || record.get(q.key) == q.value;
+}
+
+int usage() {
+    fprintf(stderr,
+	    "usage: ptclogs-grep [--level LEVEL] [--field KEY=VALUE] [--threads N] [--count] "
+	    "PATTERN FILE...\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Query q;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool count = false;
+    std::vector<const char*> positional;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	bool has_value = i + 1 < argc;
+	if (arg == "--level" && has_value) {
+	    logger::LogLevel level;
+	    if (!logger::parse_level(argv[++i], level)) return usage();
+	    q.levels = (2u << level) - 1;
+	} else if (arg == "--field" && has_value) {
+	    std::string_view kv = argv[++i];
+	    std::size_t eq = kv.find('=');
+	    if (eq == std::string_view::npos) return usage();
+	    q.key = kv.substr(0, eq);
+	    q.value = kv.substr(eq + 1);
+	} else if (arg == "--threads" && has_value) {
+	    threads = std::max(1, atoi(argv[++i]));
+	} else if (arg == "--count") {
+	    count = true;
+	} else {
+	    positional.push_back(argv[i]);
+	}
+    }
+    if (positional.size() < 2) return usage();
+    q.pattern = positional[0];
+
+    // windows bound the memory held by pending output
+    const std::size_t window = std::size_t(threads) << 24;
+    std::size_t total = 0;
+    std::vector<std::string> out(threads);
+    std::vector<std::size_t> counts(threads);
+    for (std::size_t f = 1; f < positional.size(); f++) {
+	logger::reader::MappedFile file;
+	if (!file.open(positional[f])) {
+	    perror(positional[f]);
+	    return 1;
+	}
+	std::string_view data = file.data();
+	logger::reader::Format format = logger::reader::detect(data);
+	while (!data.empty()) {
+	    std::size_t cut = data.size();
+	    if (cut > window) {
+		const char* end = data.data() + data.size();
+		cut = logger::reader::find_newline(data.data() + window, end) - data.data();
+		cut = std::min(cut + 1, data.size());
+	    }
+	    logger::reader::parallel_scan(
+		data.substr(0, cut), format, threads,
+		[&](std::size_t part, const logger::reader::Record& record) {
+		    if (!matches(q, record)) return;
+		    counts[part]++;
+		    if (!count) (out[part] += record.line) += '\n';
+		});
+	    for (unsigned i = 0; i < threads; i++) {
+		fwrite(out[i].data(), 1, out[i].size(), stdout);
+		out[i].clear();
+		total += counts[i];
+		counts[i] = 0;
+	    }
+	    data.remove_prefix(cut);
+	}
+    }
+    if (count) printf("%zu\n", total);
+    return total ? 0 : 1;
+}
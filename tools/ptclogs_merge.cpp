@@ -0,0 +1,183 @@
+/**
+ * ptclogs-merge: merges ptclogs files into one time ordered stream.
+ *
+ * usage: ptclogs-merge [-o OUTPUT] FILE...
+ *
+ * Every input has a reader thread that parses the ts of its lines ahead of
+ * the merge, in a bounded number of batches, and the main thread k-way merges
+ * the batches. Inputs are memory mapped and lines are never copied until
+ * written, so files of any size are merged in bounded memory. Records with
+ * equal timestamps keep the order of the inputs given on the command line,
+ * and the lines of each input keep their order.
+ *
+ * ts is written with whole seconds, so the merge is ordered to the second
+ * only: the records of one second come input by input, not interleaved in
+ * the order they were logged.
+ */
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ptclogs/reader.hpp"
+
+namespace {
+struct Line {
+    std::string_view ts;
+    std::string_view text;
+};
+
+/**
+ * @brief One input file and the batches its reader thread parsed ahead.
+ */
+class Source {
+ public:
+    static constexpr std::size_t batch_lines = 4096;
+    static constexpr std::size_t max_batches = 4;
+
+    bool open(const char* path) {
+	if (!file.open(path)) return false;
+	reader = std::thread(&Source::run, this);
+	return true;
+    }
+
+    ~Source() {
+	{
+	    std::lock_guard<std::mutex> lock(mutex);
+	    stopped = true;
+	}
+	changed.notify_all();
+	if (reader.joinable()) reader.join();
+    }
+
+    /**
+     * @brief Waits for the next batch.
+     *
+     * @return Whether there was one, false once the file is exhausted.
+     */
+    bool next(std::vector<Line>& batch) {
+	std::unique_lock<std::mutex> lock(mutex);
+	changed.wait(lock, [this] { return !ready.empty() || finished; });
+	if (ready.empty()) return false;
+	batch = std::move(ready.front());
+	ready.pop_front();
+	lock.unlock();
+	changed.notify_all();
+	return true;
+    }
+
+ private:
+    void run() {
+	std::string_view data = file.data();
+	logger::reader::Format format = logger::reader::detect(data);
+	std::vector<Line> batch;
+	std::string_view last;
+	logger::reader::for_each_line(data, [&](std::string_view text) {
+	    if (stopped) return;
+	    // lines without a timestamp stay with the record before them
+	    std::string_view ts = logger::reader::timestamp(text, format);
+	    if (!ts.empty()) last = ts;
+	    batch.push_back(Line{last, text});
+	    if (batch.size() == batch_lines) push(batch);
+	});
+	push(batch);
+	std::lock_guard<std::mutex> lock(mutex);
+	finished = true;
+	changed.notify_all();
+    }
+
+    void push(std::vector<Line>& batch) {
+	if (batch.empty()) return;
+	std::unique_lock<std::mutex> lock(mutex);
+	changed.wait(lock, [this] { return ready.size() < max_batches || stopped; });
+	ready.push_back(std::move(batch));
+	lock.unlock();
+	changed.notify_all();
+	batch.clear();
+	batch.reserve(batch_lines);
+    }
+
+    logger::reader::MappedFile file;
+    std::thread reader;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<Line>> ready;
+    bool finished = false;
+    std::atomic<bool> stopped{false};
+};
+
+/**
+ * @brief Position of the merge in one source.
+ */
+struct Cursor {
+    std::vector<Line> batch;
+    std::size_t pos = 0;
+};
+
+int usage() {
+    fprintf(stderr, "usage: ptclogs-merge [-o OUTPUT] FILE...\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* output = nullptr;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	if (arg == "-o" && i + 1 < argc)
+	    output = argv[++i];
+	else if (arg[0] == '-' && arg.size() > 1)
+	    return usage();
+	else
+	    paths.push_back(argv[i]);
+    }
+    if (paths.empty()) return usage();
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+	perror(output);
+	return 1;
+    }
+
+    std::vector<Source> sources(paths.size());
+    std::vector<Cursor> cursors(paths.size());
+    for (std::size_t i = 0; i < paths.size(); i++)
+	if (!sources[i].open(paths[i])) {
+	    perror(paths[i]);
+	    return 1;
+	}
+
+    auto later = [&cursors](std::size_t a, std::size_t b) {
+	std::string_view ta = cursors[a].batch[cursors[a].pos].ts;
+	std::string_view tb = cursors[b].batch[cursors[b].pos].ts;
+	return ta != tb ? ta > tb : a > b;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+    for (std::size_t i = 0; i < sources.size(); i++)
+	if (sources[i].next(cursors[i].batch)) heap.push(i);
+
+    std::string buffer;
+    while (!heap.empty()) {
+	std::size_t i = heap.top();
+	heap.pop();
+	Cursor& c = cursors[i];
+	(buffer += c.batch[c.pos].text) += '\n';
+	if (buffer.size() >= 1 << 20) {
+	    fwrite(buffer.data(), 1, buffer.size(), out);
+	    buffer.clear();
+	}
+	if (++c.pos == c.batch.size()) {
+	    c.pos = 0;
+	    if (!sources[i].next(c.batch)) continue;
+	}
+	heap.push(i);
+    }
+    fwrite(buffer.data(), 1, buffer.size(), out);
+    return fclose(out) == 0 ? 0 : 1;
+}
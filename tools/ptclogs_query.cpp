@@ -0,0 +1,163 @@
+/**
+ * ptclogs-query: prints the records of a JSON log file matching a time range,
+ * a level and a key, reading only the blocks its sidecar index points at.
+ *
+ * usage: ptclogs-query [--from TIME] [--to TIME] [--level LEVEL]
+ *                      [--key KEY=VALUE] [--verbose] FILE
+ *
+ * TIME is an ISO 8601 UTC time like 2021-10-08T07:07:09Z, both ends are
+ * inclusive. LEVEL selects records at that level or more severe.
+ */
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "ptclogs/driver/idriver.hpp"
+#include "ptclogs/index.hpp"
+
+namespace {
+struct Query {
+    std::int64_t from = INT64_MIN;
+    std::int64_t to = INT64_MAX;
+    unsigned levels = ~0u;
+    std::string key;
+    std::string value;
+};
+
+bool parse_time(std::string_view text, std::int64_t& seconds) {
+    tm t{};
+    std::string s(text);
+    const char* end = strptime(s.c_str(), "%Y-%m-%dT%H:%M:%S", &t);
+    if (!end || (*end && std::strcmp(end, "Z") != 0)) return false;
+    seconds = timegm(&t);
+    return true;
+}
+
+bool matches(const Query& q, std::string_view line) {
+    std::int64_t seconds;
+    if (!parse_time(logger::index::find_value(line, "ts"), seconds) || seconds < q.from ||
+	seconds > q.to)
+	return false;
+    logger::LogLevel level;
+    if (!logger::parse_level(logger::index::find_value(line, "level"), level) ||
+	!(q.levels >> level & 1))
+	return false;
+    return q.key.empty() || logger::index::find_value(line, q.key) == q.value;
+}
+
+/**
+ * @brief Prints the matching records of a byte range of the log file, reading
+ * it in chunks.
+ */
+void scan(int fd, const Query& q, std::uint64_t offset, std::uint64_t size) {
+    constexpr std::size_t chunk = 1 << 20;
+    std::string data;
+    while (size > 0) {
+	std::size_t kept = data.size();
+	data.resize(kept + std::min<std::uint64_t>(chunk, size));
+	ssize_t n = pread(fd, data.data() + kept, data.size() - kept, offset);
+	if (n <= 0) return;
+	data.resize(kept + n);
+	offset += n;
+	size -= n;
+
+	std::string_view rest(data);
+	for (std::size_t end; (end = rest.find('\n')) != std::string_view::npos || size == 0;) {
+	    std::string_view line = rest.substr(0, end == std::string_view::npos ? end : end + 1);
+	    if (line.empty()) break;
+	    if (matches(q, line)) fwrite(line.data(), 1, line.size(), stdout);
+	    rest.remove_prefix(line.size());
+	}
+	data.erase(0, data.size() - rest.size());
+    }
+}
+
+int usage() {
+    fprintf(stderr,
+	    "usage: ptclogs-query [--from TIME] [--to TIME] [--level LEVEL] "
+	    "[--key KEY=VALUE] [--verbose] FILE\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Query q;
+    bool verbose = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	bool has_value = i + 1 < argc;
+	if (arg == "--from" && has_value) {
+	    if (!parse_time(argv[++i], q.from)) return usage();
+	} else if (arg == "--to" && has_value) {
+	    if (!parse_time(argv[++i], q.to)) return usage();
+	} else if (arg == "--level" && has_value) {
+	    logger::LogLevel level;
+	    if (!logger::parse_level(argv[++i], level)) return usage();
+	    q.levels = (2u << level) - 1;
+	} else if (arg == "--key" && has_value) {
+	    std::string_view kv = argv[++i];
+	    std::size_t eq = kv.find('=');
+	    if (eq == std::string_view::npos) return usage();
+	    q.key = kv.substr(0, eq);
+	    q.value = kv.substr(eq + 1);
+	} else if (arg == "--verbose") {
+	    verbose = true;
+	} else if (!path && arg[0] != '-') {
+	    path = argv[i];
+	} else {
+	    return usage();
+	}
+    }
+    if (!path) return usage();
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+	perror(path);
+	return 1;
+    }
+    logger::index::Index idx;
+    if (!idx.load(std::string(path) + ".idx")) {
+	fprintf(stderr, "%s.idx: not an index, scanning the whole file\n", path);
+	scan(fd, q, 0, st.st_size);
+	return 0;
+    }
+
+    // blocks are indexed by commit time, which may be past the second in ts
+    std::int64_t from_ns = q.from == INT64_MIN ? INT64_MIN : (q.from - 1) * 1000000000;
+    std::int64_t to_ns = q.to == INT64_MAX ? INT64_MAX : (q.to + 2) * 1000000000;
+    bool bloom = false;
+    for (auto& key : idx.options.keys) bloom = bloom || key == q.key;
+
+    std::uint64_t scanned = 0, skipped = 0, covered = 0;
+    for (auto& block : idx.blocks) {
+	// ranges the index doesn't cover are scanned whole
+	if (block.offset > covered) {
+	    scan(fd, q, covered, block.offset - covered);
+	    scanned += block.offset - covered;
+	}
+	covered = block.offset + block.size;
+	if (block.last_ns < from_ns || block.first_ns > to_ns || !(block.levels & q.levels) ||
+	    (bloom && !block.may_contain(q.key, q.value))) {
+	    skipped += block.size;
+	    continue;
+	}
+	scan(fd, q, block.offset, block.size);
+	scanned += block.size;
+    }
+    if (std::uint64_t(st.st_size) > covered) {
+	scan(fd, q, covered, st.st_size - covered);
+	scanned += st.st_size - covered;
+    }
+    if (verbose)
+	fprintf(stderr, "scanned %llu bytes, skipped %llu bytes in %zu blocks\n",
+		(unsigned long long)scanned, (unsigned long long)skipped, idx.blocks.size());
+    return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * ptclogs-symbolize: replaces the module+0xoffset frames of stack traces in
+ * ptclogs files with the function and source line they belong to.
+ *
+ * usage: ptclogs-symbolize [--addr2line PATH] [--root DIR] [FILE...]
+ *
+ * Reads the files, or stdin, and writes the records to stdout with every
+ * frame that resolves replaced by "function (file:line)". Lines are read in
+ * batches, and the new frames of a batch are resolved with one addr2line run
+ * per module; results are cached per frame. DIR is prepended to the module
+ * paths, for traces logged on another machine whose binaries are copied
+ * under DIR.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+struct Frame {
+    std::size_t start;
+    std::size_t end;
+    std::string module;
+    unsigned long long offset;
+};
+
+struct Options {
+    std::string addr2line = "addr2line";
+    std::string root;
+};
+
+bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/**
+ * @brief Finds the module+0xoffset frames of a line.
+ */
+std::vector<Frame> find_frames(std::string_view line) {
+    std::vector<Frame> frames;
+    std::size_t at = 0;
+    while ((at = line.find("+0x", at)) != std::string_view::npos) {
+	std::size_t start = at;
+	while (start > 0 && line[start - 1] != '"' && line[start - 1] != ' ' &&
+	       line[start - 1] != '[' && line[start - 1] != ',' && line[start - 1] != '=')
+	    start--;
+	std::size_t end = at + 3;
+	while (end < line.size() && is_hex(line[end])) end++;
+	if (start < at && end > at + 3 && line[start] == '/') {
+	    std::string digits(line.substr(at + 3, end - at - 3));
+	    frames.push_back(Frame{start, end, std::string(line.substr(start, at - start)),
+				   std::stoull(digits, nullptr, 16)});
+	}
+	at = end;
+    }
+    return frames;
+}
+
+std::string shell_quote(const std::string& s) {
+    std::string quoted = "'";
+    for (char c : s) {
+	if (c == '\'')
+	    quoted += "'\\''";
+	else
+	    quoted += c;
+    }
+    return quoted + "'";
+}
+
+/**
+ * @brief Escapes a resolved frame so it can replace text inside a JSON
+ * string.
+ */
+std::string escape(const std::string& s) {
+    std::string escaped;
+    for (char c : s) {
+	if (c == '"' || c == '\\') escaped += '\\';
+	escaped += c;
+    }
+    return escaped;
+}
+
+using Key = std::pair<std::string, unsigned long long>;
+
+/**
+ * @brief Resolves offsets of one module with addr2line, leaving the frames
+ * it doesn't know out of the cache's resolved entries.
+ */
+void resolve(const Options& options, const std::string& module,
+	     const std::set<unsigned long long>& offsets, std::map<Key, std::string>& cache) {
+    // a command line is bounded, so offsets are resolved a chunk at a time
+    const std::size_t chunk = 256;
+    std::vector<unsigned long long> pending(offsets.begin(), offsets.end());
+    for (std::size_t from = 0; from < pending.size(); from += chunk) {
+	std::string command = shell_quote(options.addr2line) + " -f -C -e " +
+			      shell_quote(options.root + module);
+	std::size_t to = std::min(pending.size(), from + chunk);
+	for (std::size_t i = from; i < to; i++) {
+	    char address[24];
+	    // return addresses point after the call
+	    snprintf(address, sizeof address, " 0x%llx", pending[i] ? pending[i] - 1 : 0);
+	    command += address;
+	}
+	command += " 2>/dev/null";
+	FILE* out = popen(command.c_str(), "r");
+	if (!out) return;
+	char function[4096], location[4096];
+	for (std::size_t i = from; i < to; i++) {
+	    if (!fgets(function, sizeof function, out) || !fgets(location, sizeof location, out))
+		break;
+	    std::string f(function), l(location);
+	    while (!f.empty() && f.back() == '\n') f.pop_back();
+	    while (!l.empty() && l.back() == '\n') l.pop_back();
+	    if (f == "??") continue;
+	    cache[Key(module, pending[i])] =
+		l.compare(0, 2, "??") == 0 ? f : f + " (" + l.substr(0, l.find(" (")) + ")";
+	}
+	pclose(out);
+    }
+}
+
+/**
+ * @brief Symbolizes and writes a batch of lines.
+ */
+void flush(const Options& options, std::vector<std::string>& lines,
+	   std::map<Key, std::string>& cache, std::set<Key>& tried) {
+    std::map<std::string, std::set<unsigned long long>> missing;
+    std::vector<std::vector<Frame>> frames(lines.size());
+    for (std::size_t i = 0; i < lines.size(); i++) {
+	frames[i] = find_frames(lines[i]);
+	for (auto& f : frames[i]) {
+	    Key key(f.module, f.offset);
+	    if (tried.insert(key).second) missing[f.module].insert(f.offset);
+	}
+    }
+    for (auto& [module, offsets] : missing) resolve(options, module, offsets, cache);
+
+    for (std::size_t i = 0; i < lines.size(); i++) {
+	std::string out;
+	std::size_t copied = 0;
+	for (auto& f : frames[i]) {
+	    auto it = cache.find(Key(f.module, f.offset));
+	    if (it == cache.end()) continue;
+	    out.append(lines[i], copied, f.start - copied);
+	    out += escape(it->second);
+	    copied = f.end;
+	}
+	out.append(lines[i], copied, std::string::npos);
+	fwrite(out.data(), 1, out.size(), stdout);
+    }
+    lines.clear();
+}
+
+int usage() {
+    fprintf(stderr, "usage: ptclogs-symbolize [--addr2line PATH] [--root DIR] [FILE...]\n");
+    return 2;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; i++) {
+	std::string_view arg = argv[i];
+	bool has_value = i + 1 < argc;
+	if (arg == "--addr2line" && has_value) {
+	    options.addr2line = argv[++i];
+	} else if (arg == "--root" && has_value) {
+	    options.root = argv[++i];
+	} else if (arg.size() > 1 && arg[0] == '-') {
+	    return usage();
+	} else {
+	    files.push_back(argv[i]);
+	}
+    }
+    if (files.empty()) files.push_back(nullptr);
+
+    const std::size_t batch_lines = 4096;
+    std::map<Key, std::string> cache;
+    std::set<Key> tried;
+    std::vector<std::string> lines;
+    int status = 0;
+    for (const char* path : files) {
+	FILE* in = path ? fopen(path, "r") : stdin;
+	if (!in) {
+	    perror(path);
+	    status = 1;
+	    continue;
+	}
+	char* line = nullptr;
+	std::size_t capacity = 0;
+	ssize_t n;
+	while ((n = getline(&line, &capacity, in)) > 0) {
+	    lines.emplace_back(line, n);
+	    if (lines.size() == batch_lines) flush(options, lines, cache, tried);
+	}
+	free(line);
+	if (path) fclose(in);
+    }
+    flush(options, lines, cache, tried);
+    return status;
+}